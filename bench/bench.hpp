@@ -0,0 +1,156 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+/// @brief 阻止编译器把结果优化掉
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+/// @brief 一条测量结果
+struct Result {
+    std::string name;
+    std::uint64_t iterations = 0;         // 每次重复执行的操作数
+    double ns_per_op = 0;                 // 各次重复的中位数
+    double min_ns_per_op = 0;
+    double max_ns_per_op = 0;
+    std::map<std::string, double> metrics; // 额外指标: 吞吐量、延迟分位数等
+};
+
+/// @brief 运行配置, 由命令行参数设置
+struct Options {
+    std::string filter;                    // 只运行名字包含该子串的测试
+    double min_time_ms = 200;              // 每次重复至少运行的时间
+    int repetitions = 5;
+    std::string json_path;                 // 为空时输出到标准输出
+    std::string trace_path;                // 开启 MSTD_TRACE 时把跟踪事件写入该文件
+};
+
+class Runner {
+public:
+    explicit Runner(Options options) : options_(std::move(options)) {}
+
+    /// @brief 是否需要运行这个测试 (名字匹配过滤条件)
+    bool enabled(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    /// @brief 测量每次操作的耗时
+    /// 先增加迭代次数直到单次运行超过 min_time, 再重复 repetitions 次取中位数
+    /// @param name 测试名, 建议用 "组件/操作/实现" 的形式
+    /// @param body 执行 n 次操作的函数
+    /// @return 结果, 已经加入结果列表; 可以继续往 metrics 里添加指标
+    Result* measure(const std::string& name, const std::function<void(std::uint64_t)>& body) {
+        if (!enabled(name)) return nullptr;
+        std::uint64_t n = 1;
+        for (;;) {
+            double ns = run_once(body, n);
+            if (ns >= options_.min_time_ms * 1e6 || n >= (1ull << 40)) break;
+            // 根据已经测到的耗时估计需要的次数, 避免多次从头试
+            double scale = ns > 0 ? options_.min_time_ms * 1e6 / ns : 10.0;
+            n = static_cast<std::uint64_t>(static_cast<double>(n) * std::min(10.0, std::max(scale * 1.2, 1.5)));
+        }
+        std::vector<double> samples;
+        for (int i = 0; i < options_.repetitions; ++i) {
+            samples.push_back(run_once(body, n) / static_cast<double>(n));
+        }
+        std::sort(samples.begin(), samples.end());
+        Result result;
+        result.name = name;
+        result.iterations = n;
+        result.ns_per_op = samples[samples.size() / 2];
+        result.min_ns_per_op = samples.front();
+        result.max_ns_per_op = samples.back();
+        result.metrics["ops_per_sec"] = 1e9 / result.ns_per_op;
+        results_.push_back(std::move(result));
+        return &results_.back();
+    }
+
+    /// @brief 运行固定工作量的测试 (多线程吞吐量等), 重复 repetitions 次取中位数
+    /// @param name 测试名
+    /// @param ops 每次运行完成的操作数
+    /// @param body 完成一次运行, 返回耗时 (纳秒)
+    Result* measure_fixed(const std::string& name, std::uint64_t ops, const std::function<double()>& body) {
+        if (!enabled(name)) return nullptr;
+        body(); // 预热
+        std::vector<double> samples;
+        for (int i = 0; i < options_.repetitions; ++i) {
+            samples.push_back(body() / static_cast<double>(ops));
+        }
+        std::sort(samples.begin(), samples.end());
+        Result result;
+        result.name = name;
+        result.iterations = ops;
+        result.ns_per_op = samples[samples.size() / 2];
+        result.min_ns_per_op = samples.front();
+        result.max_ns_per_op = samples.back();
+        result.metrics["ops_per_sec"] = 1e9 / result.ns_per_op;
+        results_.push_back(std::move(result));
+        return &results_.back();
+    }
+
+    const std::vector<Result>& results() const {
+        return results_;
+    }
+
+    const Options& options() const {
+        return options_;
+    }
+
+private:
+    static double run_once(const std::function<void(std::uint64_t)>& body, std::uint64_t n) {
+        auto start = Clock::now();
+        body(n);
+        clobber_memory();
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    Options options_;
+    std::vector<Result> results_; // 用 vector 保存, 返回的指针在下一次 measure 前有效
+};
+
+/// @brief 从 start 到现在经过的纳秒数
+inline double elapsed_ns(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+/// @brief 对样本排序后取分位数 (0~1)
+inline double percentile(std::vector<double>& samples, double q) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(q * static_cast<double>(samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+// 各组件的测试, 分别在对应的 *_bench.cpp 中实现
+void vector_benchmarks(Runner& runner);
+void string_benchmarks(Runner& runner);
+void function_benchmarks(Runner& runner);
+void thread_pool_benchmarks(Runner& runner);
+void lock_free_queue_benchmarks(Runner& runner);
+void file_cache_benchmarks(Runner& runner);
+void yaml_benchmarks(Runner& runner);
+
+}
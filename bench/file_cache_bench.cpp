@@ -0,0 +1,100 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include "bench.hpp"
+#include "mstd/FileCache.hpp"
+
+namespace bench {
+
+namespace {
+
+constexpr int file_count = 64;
+constexpr size_t file_size = 4096;
+
+// 在临时目录下生成测试文件, 析构时删除
+class TempFiles {
+public:
+    TempFiles() {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("mstd_bench_" + std::to_string(Clock::now().time_since_epoch().count()));
+        std::filesystem::create_directories(dir_);
+        for (int i = 0; i < file_count; ++i) {
+            std::string path = (dir_ / ("file" + std::to_string(i) + ".html")).string();
+            std::ofstream(path, std::ios::binary) << std::string(file_size, static_cast<char>('a' + i % 26));
+            paths_.push_back(path);
+        }
+    }
+
+    ~TempFiles() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+    }
+
+    const std::vector<std::string>& paths() const {
+        return paths_;
+    }
+
+private:
+    std::filesystem::path dir_;
+    std::vector<std::string> paths_;
+};
+
+// threads 个线程各读取 per_thread 次, 按不同步长轮流访问所有文件
+double run_gets(mstd::FileCache& cache, const std::vector<std::string>& paths, int threads, std::uint64_t per_thread) {
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            size_t index = static_cast<size_t>(t);
+            for (std::uint64_t i = 0; i < per_thread; ++i) {
+                index = (index + 2 * static_cast<size_t>(t) + 1) % paths.size();
+                auto result = cache.get_shared(paths[index]);
+                do_not_optimize(result);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    return elapsed_ns(start);
+}
+
+}
+
+void file_cache_benchmarks(Runner& runner) {
+    const int hardware = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> thread_counts{1};
+    if (hardware >= 4) thread_counts.push_back(4);
+    if (hardware > 4) thread_counts.push_back(hardware);
+
+    // 没有要运行的测试时不生成临时文件
+    bool any = false;
+    for (int threads : thread_counts) {
+        std::string suffix = "/threads_" + std::to_string(threads);
+        any = any || runner.enabled("file_cache/hit" + suffix) || runner.enabled("file_cache/miss" + suffix);
+    }
+    if (!any) return;
+
+    TempFiles files;
+    for (int threads : thread_counts) {
+        std::string suffix = "/threads_" + std::to_string(threads);
+
+        // 命中: 缓存足够大, 预热后全部命中 (每次仍会检查文件修改时间)
+        constexpr std::uint64_t hit_ops = 20000;
+        mstd::FileCache warm;
+        for (const auto& path : files.paths()) warm.get_shared(path);
+        runner.measure_fixed("file_cache/hit" + suffix, hit_ops * static_cast<std::uint64_t>(threads),
+                             [&] { return run_gets(warm, files.paths(), threads, hit_ops); });
+
+        // 未命中: 缓存只能放下 1/8 的文件, 大部分访问都要重新读文件并淘汰旧条目
+        constexpr std::uint64_t miss_ops = 2000;
+        mstd::FileCache small(file_size * file_count / 8);
+        Result* result = runner.measure_fixed("file_cache/miss" + suffix, miss_ops * static_cast<std::uint64_t>(threads),
+                                              [&] { return run_gets(small, files.paths(), threads, miss_ops); });
+        if (result) {
+            double total = static_cast<double>(small.get_cache_hits() + small.get_cache_misses());
+            result->metrics["miss_ratio"] = total > 0 ? static_cast<double>(small.get_cache_misses()) / total : 0;
+        }
+    }
+}
+
+}
@@ -0,0 +1,38 @@
+#include <functional>
+#include "bench.hpp"
+#include "mstd/function.hpp"
+
+namespace bench {
+
+namespace {
+
+template <typename Func>
+void construct(std::uint64_t n) {
+    int offset = 3;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        Func f([offset](int x) { return x + offset; });
+        do_not_optimize(f);
+    }
+}
+
+template <typename Func>
+void call(std::uint64_t n) {
+    int offset = 3;
+    Func f([offset](int x) { return x + offset; });
+    int acc = 0;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        acc = f(acc);
+        do_not_optimize(acc);
+    }
+}
+
+}
+
+void function_benchmarks(Runner& runner) {
+    runner.measure("function/construct_lambda/mstd", construct<mstd::Function<int(int)>>);
+    runner.measure("function/construct_lambda/std", construct<std::function<int(int)>>);
+    runner.measure("function/call/mstd", call<mstd::Function<int(int)>>);
+    runner.measure("function/call/std", call<std::function<int(int)>>);
+}
+
+}
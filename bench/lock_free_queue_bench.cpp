@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include "bench.hpp"
+#include "mstd/LockFreeQueue.hpp"
+
+namespace bench {
+
+namespace {
+
+// 作为对照的加锁队列, 接口和 LockFreeQueue 一致
+template <typename T>
+class MutexQueue {
+public:
+    template <typename U>
+    void enqueue(U&& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(std::make_shared<T>(std::forward<U>(value)));
+    }
+
+    std::shared_ptr<T> dequeue() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) return nullptr;
+        auto value = std::move(queue_.front());
+        queue_.pop();
+        return value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::queue<std::shared_ptr<T>> queue_;
+};
+
+// producers 个线程各入队 per_producer 个数, consumers 个线程一起取完, 返回耗时
+template <typename Queue>
+double run_mpmc(int producers, int consumers, std::uint64_t per_producer) {
+    Queue queue;
+    const std::uint64_t total = per_producer * static_cast<std::uint64_t>(producers);
+    std::atomic<std::uint64_t> consumed{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (std::uint64_t i = 0; i < per_producer; ++i) queue.enqueue(i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (auto value = queue.dequeue()) {
+                    do_not_optimize(*value);
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    return elapsed_ns(start);
+}
+
+}
+
+void lock_free_queue_benchmarks(Runner& runner) {
+    constexpr std::uint64_t per_producer = 100000;
+    const int hardware = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    for (int n : {1, 2, 4}) {
+        if (n > 1 && n * 2 > hardware) break;
+        std::string shape = "/mpmc_" + std::to_string(n) + "x" + std::to_string(n);
+        std::uint64_t ops = per_producer * static_cast<std::uint64_t>(n);
+        runner.measure_fixed("lock_free_queue" + shape + "/mstd", ops,
+                             [&] { return run_mpmc<mstd::LockFreeQueue<std::uint64_t>>(n, n, per_producer); });
+        runner.measure_fixed("lock_free_queue" + shape + "/mutex_queue", ops,
+                             [&] { return run_mpmc<MutexQueue<std::uint64_t>>(n, n, per_producer); });
+    }
+}
+
+}
@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "bench.hpp"
+#include "mstd/trace.hpp"
+
+namespace {
+
+void usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " [--filter <substr>] [--min-time <ms>] [--repetitions <n>] [--json <file>] [--trace <file>]\n"
+              << "  表格输出到 stderr, JSON 输出到 --json 指定的文件 (默认 stdout)\n"
+              << "  --trace 需要用 MSTD_TRACE 构建, 跟踪事件只保留每个线程最近的一部分\n";
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string json_number(double value) {
+    std::ostringstream os;
+    os.precision(6);
+    os << value;
+    return os.str();
+}
+
+void write_json(std::ostream& os, const bench::Runner& runner) {
+    os << "{\n";
+    os << "  \"schema\": 1,\n";
+    os << "  \"timestamp\": " << static_cast<long long>(std::time(nullptr)) << ",\n";
+#ifdef __VERSION__
+    os << "  \"compiler\": \"" << json_escape(__VERSION__) << "\",\n";
+#endif
+#ifdef MSTD_BENCH_BUILD_TYPE
+    os << "  \"build_type\": \"" << json_escape(MSTD_BENCH_BUILD_TYPE) << "\",\n";
+#endif
+    os << "  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n";
+    os << "  \"min_time_ms\": " << json_number(runner.options().min_time_ms) << ",\n";
+    os << "  \"repetitions\": " << runner.options().repetitions << ",\n";
+    os << "  \"results\": [";
+    const auto& results = runner.results();
+    for (size_t i = 0; i < results.size(); ++i) {
+        const bench::Result& r = results[i];
+        os << (i ? ",\n" : "\n");
+        os << "    {\"name\": \"" << json_escape(r.name) << "\", \"iterations\": " << r.iterations
+           << ", \"ns_per_op\": " << json_number(r.ns_per_op) << ", \"min_ns_per_op\": " << json_number(r.min_ns_per_op)
+           << ", \"max_ns_per_op\": " << json_number(r.max_ns_per_op) << ", \"metrics\": {";
+        bool first = true;
+        for (const auto& metric : r.metrics) {
+            os << (first ? "" : ", ") << "\"" << json_escape(metric.first) << "\": " << json_number(metric.second);
+            first = false;
+        }
+        os << "}}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+void print_table(const bench::Runner& runner) {
+    std::fprintf(stderr, "%-52s %14s %14s\n", "benchmark", "ns/op", "ops/s");
+    for (const bench::Result& r : runner.results()) {
+        auto it = r.metrics.find("ops_per_sec");
+        std::fprintf(stderr, "%-52s %14.2f %14.0f", r.name.c_str(), r.ns_per_op, it != r.metrics.end() ? it->second : 0.0);
+        for (const auto& metric : r.metrics) {
+            if (metric.first != "ops_per_sec") std::fprintf(stderr, "  %s=%.2f", metric.first.c_str(), metric.second);
+        }
+        std::fprintf(stderr, "\n");
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    bench::Options options;
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (std::strcmp(argv[i], "--filter") == 0) {
+            options.filter = value();
+        } else if (std::strcmp(argv[i], "--min-time") == 0) {
+            options.min_time_ms = std::atof(value());
+        } else if (std::strcmp(argv[i], "--repetitions") == 0) {
+            options.repetitions = std::max(1, std::atoi(value()));
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            options.json_path = value();
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            options.trace_path = value();
+        } else {
+            usage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+
+    bench::Runner runner(options);
+    bench::vector_benchmarks(runner);
+    bench::string_benchmarks(runner);
+    bench::function_benchmarks(runner);
+    bench::thread_pool_benchmarks(runner);
+    bench::lock_free_queue_benchmarks(runner);
+    bench::file_cache_benchmarks(runner);
+    bench::yaml_benchmarks(runner);
+
+    print_table(runner);
+    if (!options.trace_path.empty()) {
+        if (!mstd::trace::enabled) {
+            std::cerr << "--trace ignored: built without MSTD_TRACE" << std::endl;
+        } else if (!mstd::trace::save(options.trace_path)) {
+            std::cerr << "failed to write " << options.trace_path << std::endl;
+        }
+    }
+    if (options.json_path.empty()) {
+        write_json(std::cout, runner);
+    } else {
+        std::ofstream out(options.json_path);
+        if (!out.is_open()) {
+            std::cerr << "failed to open " << options.json_path << std::endl;
+            return 1;
+        }
+        write_json(out, runner);
+    }
+    return 0;
+}
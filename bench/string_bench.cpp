@@ -0,0 +1,54 @@
+#include <string>
+#include "bench.hpp"
+#include "mstd/string.hpp"
+
+namespace bench {
+
+namespace {
+
+template <typename String>
+void copy(const String& source, std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+        String copied(source);
+        do_not_optimize(copied);
+    }
+}
+
+template <typename String>
+void substr(const String& source, std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+        String part = source.substr(i % 64, 128);
+        do_not_optimize(part);
+    }
+}
+
+template <typename String>
+void find(const String& source, std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+        std::size_t pos = source.find('#');
+        do_not_optimize(pos);
+    }
+}
+
+}
+
+void string_benchmarks(Runner& runner) {
+    // 短字符串在 std::string 的 SSO 范围内, 长字符串 1KB
+    const std::string shortText = "hello, mstd!";
+    std::string longText(1024, 'x');
+    longText.back() = '#';
+
+    const mstd::string mstdShort(shortText.c_str(), shortText.size());
+    const mstd::string mstdLong(longText.c_str(), longText.size());
+
+    runner.measure("string/copy_short/mstd", [&](std::uint64_t n) { copy(mstdShort, n); });
+    runner.measure("string/copy_short/std", [&](std::uint64_t n) { copy(shortText, n); });
+    runner.measure("string/copy_1k/mstd", [&](std::uint64_t n) { copy(mstdLong, n); });
+    runner.measure("string/copy_1k/std", [&](std::uint64_t n) { copy(longText, n); });
+    runner.measure("string/substr_128/mstd", [&](std::uint64_t n) { substr(mstdLong, n); });
+    runner.measure("string/substr_128/std", [&](std::uint64_t n) { substr(longText, n); });
+    runner.measure("string/find_char_1k/mstd", [&](std::uint64_t n) { find(mstdLong, n); });
+    runner.measure("string/find_char_1k/std", [&](std::uint64_t n) { find(longText, n); });
+}
+
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "bench.hpp"
+#include "mstd/ThreadPool.hpp"
+
+namespace bench {
+
+namespace {
+
+// 测试的线程数: 1, 2, 4 ... 直到硬件线程数
+std::vector<size_t> thread_counts() {
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < hardware; n *= 2) counts.push_back(n);
+    counts.push_back(hardware);
+    return counts;
+}
+
+}
+
+void thread_pool_benchmarks(Runner& runner) {
+    constexpr std::uint64_t tasks = 100000;
+    constexpr int latency_samples = 2000;
+
+    for (size_t threads : thread_counts()) {
+        std::string suffix = "/threads_" + std::to_string(threads);
+        std::string throughput_name = "thread_pool/throughput" + suffix;
+        std::string latency_name = "thread_pool/latency" + suffix;
+        if (!runner.enabled(throughput_name) && !runner.enabled(latency_name)) continue;
+
+        mstd::ThreadPool pool(threads);
+
+        // 吞吐量: 一个线程提交空任务, 全部执行完为止
+        runner.measure_fixed(throughput_name, tasks, [&] {
+            std::atomic<std::uint64_t> done{0};
+            auto start = Clock::now();
+            for (std::uint64_t i = 0; i < tasks; ++i) {
+                pool.enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+            while (done.load(std::memory_order_acquire) < tasks) std::this_thread::yield();
+            return elapsed_ns(start);
+        });
+
+        // 延迟: 从提交到任务开始执行的时间, 每次等上一个任务完成再提交
+        std::vector<double> samples;
+        Result* result = runner.measure_fixed(latency_name, latency_samples, [&] {
+            samples.clear();
+            auto start = Clock::now();
+            for (int i = 0; i < latency_samples; ++i) {
+                auto submitted = Clock::now();
+                samples.push_back(pool.enqueue([submitted] { return elapsed_ns(submitted); }).get());
+            }
+            return elapsed_ns(start);
+        });
+        if (result) {
+            result->metrics["start_p50_ns"] = percentile(samples, 0.5);
+            result->metrics["start_p99_ns"] = percentile(samples, 0.99);
+        }
+    }
+}
+
+}
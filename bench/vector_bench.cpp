@@ -0,0 +1,43 @@
+#include <vector>
+#include "bench.hpp"
+#include "mstd/vector.hpp"
+
+namespace bench {
+
+namespace {
+
+constexpr int push_count = 1024;
+constexpr int iterate_count = 64 * 1024;
+
+template <typename Vector>
+void push_back(std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+        Vector v;
+        for (int k = 0; k < push_count; ++k) v.push_back(k);
+        do_not_optimize(v);
+    }
+}
+
+template <typename Vector>
+void iterate(std::uint64_t n) {
+    Vector v;
+    for (int k = 0; k < iterate_count; ++k) v.push_back(k);
+    for (std::uint64_t i = 0; i < n; ++i) {
+        long long sum = 0;
+        for (int x : v) sum += x;
+        do_not_optimize(sum);
+    }
+}
+
+}
+
+void vector_benchmarks(Runner& runner) {
+    // 每次操作: 从空开始 push_back 1024 个 int
+    runner.measure("vector/push_back_1k/mstd", push_back<mstd::vector<int>>);
+    runner.measure("vector/push_back_1k/std", push_back<std::vector<int>>);
+    // 每次操作: 用范围 for 遍历 64K 个 int 求和
+    runner.measure("vector/iterate_64k/mstd", iterate<mstd::vector<int>>);
+    runner.measure("vector/iterate_64k/std", iterate<std::vector<int>>);
+}
+
+}
@@ -0,0 +1,110 @@
+#include <cstring>
+#include <string>
+#include "bench.hpp"
+#include "mstd/yaml.hpp"
+
+namespace bench {
+
+namespace {
+
+// 生成配置文件, 每节约 200 字节: 包含字符串、整数、布尔、浮点、流式列表和块列表
+std::string generate_document(size_t target_bytes) {
+    std::string text;
+    for (int i = 0; text.size() < target_bytes; ++i) {
+        std::string n = std::to_string(i);
+        text += "# section " + n + "\n";
+        text += "service_" + n + ":\n";
+        text += "  name: \"service number " + n + "\"\n";
+        text += "  host: 10.0." + std::to_string(i / 256 % 256) + "." + std::to_string(i % 256) + "\n";
+        text += "  port: " + std::to_string(8000 + i) + "\n";
+        text += "  enabled: " + std::string(i % 3 ? "true" : "false") + "\n";
+        text += "  ratio: 0." + std::to_string(i % 1000) + "\n";
+        text += "  tags: [alpha, beta, gamma]\n";
+        text += "  limits:\n";
+        text += "    connections: " + std::to_string(100 + i % 900) + "\n";
+        text += "    timeout: 30\n";
+        text += "  replicas:\n";
+        text += "    - replica-a-" + n + "\n";
+        text += "    - replica-b-" + n + "\n";
+    }
+    return text;
+}
+
+// 只统计事件数, 用来单独测量扫描和事件生成的开销
+struct CountingHandler : mstd::yaml::EventHandler {
+    std::uint64_t events = 0;
+    void start_mapping() { ++events; }
+    void end_mapping() { ++events; }
+    void start_sequence(bool) { ++events; }
+    void end_sequence() { ++events; }
+    void on_key(mstd::string_view) { ++events; }
+    void on_scalar(mstd::string_view, bool) { ++events; }
+};
+
+void add_throughput(Result* result, size_t bytes) {
+    if (result) result->metrics["mb_per_sec"] = static_cast<double>(bytes) / result->ns_per_op * 1e9 / (1024.0 * 1024.0);
+}
+
+void parse_benchmarks(Runner& runner, const char* size_name, size_t bytes) {
+    std::string dom_name = std::string("yaml/parse_") + size_name + "/dom";
+    std::string events_name = std::string("yaml/parse_") + size_name + "/events";
+    std::string memcpy_name = std::string("yaml/parse_") + size_name + "/memcpy";
+    if (!runner.enabled(dom_name) && !runner.enabled(events_name) && !runner.enabled(memcpy_name)) return;
+    const std::string text = generate_document(bytes);
+    const mstd::string_view view(text.data(), text.size());
+
+    // 每次操作: 解析整个文档
+    add_throughput(runner.measure(dom_name, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; ++i) {
+            auto reader = mstd::YamlReader::fromString(view);
+            do_not_optimize(reader);
+        }
+    }), text.size());
+
+    add_throughput(runner.measure(events_name, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; ++i) {
+            CountingHandler handler;
+            mstd::yaml::parseEvents(view, handler);
+            do_not_optimize(handler.events);
+        }
+    }), text.size());
+
+    // 基线: 只把文本复制一遍, 解析吞吐量的上限
+    std::string copy(text.size(), '\0');
+    add_throughput(runner.measure(memcpy_name, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; ++i) {
+            std::memcpy(copy.data(), text.data(), text.size());
+            do_not_optimize(copy);
+        }
+    }), text.size());
+}
+
+}
+
+void yaml_benchmarks(Runner& runner) {
+    parse_benchmarks(runner, "1kb", 1024);
+    parse_benchmarks(runner, "1mb", 1024 * 1024);
+    parse_benchmarks(runner, "100mb", 100 * 1024 * 1024);
+
+    if (!runner.enabled("yaml/get_nested/string_path") && !runner.enabled("yaml/get_nested/yaml_path")) return;
+    const std::string text = generate_document(1024 * 1024);
+    const mstd::YamlReader reader = mstd::YamlReader::fromString(mstd::string_view(text.data(), text.size()));
+    const std::string key = "service_1000.limits.connections";
+    const mstd::YamlPath path(key.c_str());
+
+    // 每次操作: 按路径读取一个深层的整数
+    runner.measure("yaml/get_nested/string_path", [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; ++i) {
+            int value = reader.get<int>(mstd::string_view(key.data(), key.size()));
+            do_not_optimize(value);
+        }
+    });
+    runner.measure("yaml/get_nested/yaml_path", [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; ++i) {
+            int value = reader.get<int>(path);
+            do_not_optimize(value);
+        }
+    });
+}
+
+}
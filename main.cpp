@@ -1,17 +1,20 @@
+#include <cstdlib>
 #include <iostream>
 #include <chrono>
 #include <iomanip>
 #include <thread>
-#include "mstd/threadPool.hpp"
-#include "mstd/fileCache.hpp"
+#include "mstd/ThreadPool.hpp"
+#include "mstd/FileCache.hpp"
 #include "mstd/vector.hpp"
 #include "mstd/string.hpp"
-#include "mstd/lockFreeQueue.hpp"
+#include "mstd/LockFreeQueue.hpp"
 #include "mstd/yaml.hpp"
 
 
 int main() {
+#ifdef _WIN32
     system("chcp 65001 > nul");
+#endif
     auto start = std::chrono::high_resolution_clock::now();
 
     
@@ -47,6 +50,8 @@ int main() {
     // 输出结果，保留六位小数
     std::cout << std::fixed << std::setprecision(6);
     std::cout << "耗时：" << duration.count() << "ms" << std::endl;
+#ifdef _WIN32
     system("pause");
+#endif
     return 0;
 }
\ No newline at end of file
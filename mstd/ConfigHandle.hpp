@@ -0,0 +1,251 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include "yaml.hpp"
+
+namespace mstd {
+
+/// @brief 可热更新的配置句柄
+/// 后台线程定期检查文件是否变化, 变化后在后台重新解析, 再发布一个不可变的快照 (RCU 方式);
+/// 读者不加锁, 只做几次原子操作, 拿到的快照在持有期间不会改变; 写者发布后等待正在读取旧指针的读者离开
+/// 更新配置时建议先写临时文件再 rename, 否则可能读到写了一半的文件 (解析失败时会保留旧版本)
+class ConfigHandle {
+public:
+    /// @brief 一个配置版本
+    struct Snapshot {
+        std::uint64_t version; // 从 1 开始, 每次成功重新加载加 1
+        YamlReader config;
+    };
+
+    /// @brief 每个线程自己持有的读取器
+    /// 版本号没变时直接返回本地缓存的快照, 热路径上只有一次原子读取, 没有引用计数的竞争
+    class Reader {
+    public:
+        explicit Reader(const ConfigHandle& handle) : handle_(&handle), snapshot_(handle.snapshot()) {}
+
+        /// @brief 返回最新的配置, 引用在下一次调用 get() 之前有效
+        const YamlReader& get() {
+            if (handle_->version_.load(std::memory_order_acquire) != snapshot_->version) {
+                snapshot_ = handle_->snapshot();
+            }
+            return snapshot_->config;
+        }
+
+        const YamlReader* operator->() {
+            return &get();
+        }
+
+        std::uint64_t version() const {
+            return snapshot_->version;
+        }
+
+    private:
+        const ConfigHandle* handle_;
+        std::shared_ptr<const Snapshot> snapshot_;
+    };
+
+    /// @brief 加载配置文件并开始监视
+    /// @param filePath 配置文件路径
+    /// @param pollInterval 检查文件变化的间隔, 为 0 时不启动后台线程, 只能手动 reload()
+    explicit ConfigHandle(std::string filePath, std::chrono::milliseconds pollInterval = std::chrono::milliseconds(1000))
+        : filePath_(std::move(filePath)), pollInterval_(pollInterval), version_(0), stop_(false) {
+        if (!reload()) {
+            // 与 YamlReader 一致: 初始加载失败时不抛异常, 发布一个空配置, 等文件修复后自动加载
+            std::cerr << "[ConfigHandle] " << lastError() << std::endl;
+            publish(YamlReader::fromString(mstd::string_view()));
+        }
+        if (pollInterval_.count() > 0) {
+            watcher_ = std::thread([this] { watch(); });
+        }
+    }
+
+    ConfigHandle(const ConfigHandle&) = delete;
+    ConfigHandle& operator=(const ConfigHandle&) = delete;
+
+    ~ConfigHandle() {
+        {
+            std::lock_guard<std::mutex> lock(stopMutex_);
+            stop_ = true;
+        }
+        stopCondition_.notify_all();
+        if (watcher_.joinable()) {
+            watcher_.join();
+        }
+        delete current_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief 当前快照, 持有返回值期间该版本一直有效
+    /// 不加锁: 读者在当前纪元的计数器上登记, 然后复制 shared_ptr (只是一次原子的引用计数加一)
+    std::shared_ptr<const Snapshot> snapshot() const {
+        const std::uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+        std::atomic<std::uint64_t>& readers = readers_[epoch & 1];
+        readers.fetch_add(1, std::memory_order_seq_cst);
+        std::shared_ptr<const Snapshot> snapshot = *current_.load(std::memory_order_seq_cst);
+        readers.fetch_sub(1, std::memory_order_release);
+        return snapshot;
+    }
+
+    /// @brief 当前配置 (持有快照的引用计数), 与 snapshot() 一样不加锁
+    YamlReader config() const {
+        return snapshot()->config;
+    }
+
+    /// @brief 当前版本号
+    std::uint64_t version() const {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    /// @brief 为当前线程创建一个读取器
+    Reader reader() const {
+        return Reader(*this);
+    }
+
+    /// @brief 立即重新读取并解析文件; 失败时保留旧的快照
+    /// @return 是否成功发布了新版本
+    bool reload() {
+        std::lock_guard<std::mutex> lock(reloadMutex_); // 只串行化写者, 读者不受影响
+        FileStamp stamp = stampOf(filePath_);
+        if (!stamp.exists) {
+            setError("Failed to open file: " + filePath_);
+            return false;
+        }
+        std::string text;
+        if (!readFile(filePath_, text)) {
+            setError("Failed to read file: " + filePath_);
+            return false;
+        }
+        try {
+            publish(YamlReader::fromBuffer(std::move(text))); // 文本直接交给文档, 不再复制一次
+        } catch (const std::exception& e) {
+            setError("Failed to parse " + filePath_ + ": " + e.what());
+            stamp_ = stamp; // 同一份错误内容不再重复解析
+            return false;
+        }
+        stamp_ = stamp;
+        setError(std::string());
+        return true;
+    }
+
+    /// @brief 最近一次加载失败的原因, 成功时为空
+    std::string lastError() const {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        return lastError_;
+    }
+
+    const std::string& path() const {
+        return filePath_;
+    }
+
+private:
+    // 用修改时间 + 文件大小判断文件是否变化
+    struct FileStamp {
+        bool exists = false;
+        std::int64_t mtimeNs = 0;
+        std::int64_t size = 0;
+
+        bool operator!=(const FileStamp& other) const {
+            return exists != other.exists || mtimeNs != other.mtimeNs || size != other.size;
+        }
+    };
+
+    static FileStamp stampOf(const std::string& path) {
+        FileStamp stamp;
+        struct stat fileStat;
+        if (stat(path.c_str(), &fileStat) != 0) return stamp;
+        stamp.exists = true;
+        stamp.size = static_cast<std::int64_t>(fileStat.st_size);
+#if defined(__linux__)
+        stamp.mtimeNs = static_cast<std::int64_t>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+#else
+        stamp.mtimeNs = static_cast<std::int64_t>(fileStat.st_mtime) * 1000000000;
+#endif
+        return stamp;
+    }
+
+    static bool readFile(const std::string& path, std::string& out) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        out.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(out.data(), static_cast<std::streamsize>(out.size()));
+        out.resize(static_cast<size_t>(file.gcount()));
+        return true;
+    }
+
+    // 先发布快照再增加版本号, 读者看到新版本号时一定能读到不旧于它的快照
+    // 只在构造函数和持有 reloadMutex_ 时调用, 同一时间只有一个写者
+    void publish(YamlReader config) {
+        std::uint64_t next = version_.load(std::memory_order_relaxed) + 1;
+        auto* fresh = new std::shared_ptr<const Snapshot>(std::make_shared<const Snapshot>(Snapshot{next, std::move(config)}));
+        std::shared_ptr<const Snapshot>* old = current_.exchange(fresh, std::memory_order_seq_cst);
+        version_.store(next, std::memory_order_release);
+        if (old) {
+            waitForReaders();
+            delete old; // 只释放旧的 shared_ptr, 仍被读者持有的快照由引用计数保证有效
+        }
+    }
+
+    // 等待所有可能还在读取旧指针的读者离开
+    // 读者登记在发布之前时, 它所在的计数器在下面两次等待之一中一定不为 0;
+    // 每次先切换纪元再等待旧计数器, 新来的读者登记到另一个计数器, 写者不会被持续的读取饿死
+    void waitForReaders() {
+        for (int i = 0; i < 2; ++i) {
+            const std::uint64_t epoch = epoch_.fetch_add(1, std::memory_order_seq_cst);
+            while (readers_[epoch & 1].load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void setError(std::string error) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        lastError_ = std::move(error);
+    }
+
+    void watch() {
+        std::unique_lock<std::mutex> lock(stopMutex_);
+        while (!stopCondition_.wait_for(lock, pollInterval_, [this] { return stop_; })) {
+            lock.unlock();
+            FileStamp stamp = stampOf(filePath_);
+            bool changed;
+            {
+                std::lock_guard<std::mutex> reloadLock(reloadMutex_);
+                changed = stamp.exists && stamp != stamp_;
+            }
+            if (changed && !reload()) {
+                std::cerr << "[ConfigHandle] " << lastError() << std::endl;
+            }
+            lock.lock();
+        }
+    }
+
+    const std::string filePath_;
+    const std::chrono::milliseconds pollInterval_;
+
+    std::atomic<std::shared_ptr<const Snapshot>*> current_{nullptr}; // 只由写者替换和释放
+    mutable std::atomic<std::uint64_t> epoch_{0};
+    mutable std::atomic<std::uint64_t> readers_[2]{{0}, {0}}; // 按纪元奇偶分开的读者计数
+    std::atomic<std::uint64_t> version_;
+
+    std::mutex reloadMutex_; // 保护 stamp_, 串行化 reload
+    FileStamp stamp_;
+
+    mutable std::mutex errorMutex_;
+    std::string lastError_;
+
+    std::mutex stopMutex_;
+    std::condition_variable stopCondition_;
+    bool stop_;
+    std::thread watcher_;
+};
+
+}
@@ -4,22 +4,39 @@
 #include <list>
 #include <unordered_map>
 #include <shared_mutex>
+#include <mutex>
 #include <fstream>
 #include "vector.hpp"
+#include "string.hpp"
+#include "ThreadPool.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <optional>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace mstd {
 
 class FileCache {
+    class MappedFile;
+
 public:
     struct CachedFile {
-        std::vector<char> content; // 文件内容
+        std::shared_ptr<const std::vector<char>> content; // 文件内容, 共享给调用方避免拷贝
         std::string mime_type; // 文件的MIME类型
         time_t last_modified; // 文件的最后修改时间
         size_t file_size; // 文件大小
         std::list<std::string>::iterator lru_it; // LRU列表中的迭代器
+        std::shared_ptr<const MappedFile> snapshot; // 从快照恢复、还没有读出内容时, 内容所在的映射
+        const char* snapshot_data = nullptr; // 内容在映射中的位置
     };
     
     //  显示构造函数
@@ -28,46 +45,84 @@ public:
 
     //  获取文件内容和类型, 先判断文件是否已经更新
     std::optional<std::pair<std::vector<char>, std::string>> get(const std::string& file_path) {
-        std::unique_lock lock(mutex_); // 多线程下所有操作都用独占锁
-        auto it = cache_.find(file_path);
-        if (it != cache_.end()) {
-            // 检查文件是否已修改
-            if (is_file_modified(file_path, it->second.last_modified)) {
-                // 文件已更新，移除旧缓存
-                current_size_ -= it->second.file_size;
-                lru_list_.erase(it->second.lru_it);
-                cache_.erase(it);
-                cache_misses_++;
+        auto result = get_shared(file_path);
+        if (!result) return std::nullopt;
+        return std::make_optional(std::make_pair(*result->first, std::move(result->second)));
+    }
+
+    //  获取文件内容和类型, 内容以共享指针返回, 不拷贝文件数据
+    //  缓存淘汰或文件更新后, 已经返回的内容仍然有效
+    //  读盘和从快照复制内容时不持有锁, 其他线程的命中不会被一次慢的加载挡住
+    std::optional<std::pair<std::shared_ptr<const std::vector<char>>, std::string>> get_shared(const std::string& file_path) {
+        std::shared_ptr<const MappedFile> snapshot;
+        const char* snapshot_data = nullptr;
+        size_t snapshot_size = 0;
+        std::string mime_type;
+        {
+            // 多线程下所有操作都用独占锁; 开启跟踪时记录等锁的时间
+            std::unique_lock lock = trace::lock(mutex_, "file_cache", "mutex_wait");
+            auto it = cache_.find(file_path);
+            if (it != cache_.end()) {
+                // 检查文件是否已修改
+                if (is_file_modified(file_path, it->second)) {
+                    // 文件已更新或者已经无法访问，移除旧缓存
+                    erase(it);
+                    cache_misses_++;
+                } else {
+                    // 更新LRU位置
+                    touch(it->second, file_path);
+                    cache_hits_++;
+                    if (it->second.content) {
+                        return std::make_optional(std::make_pair(it->second.content, it->second.mime_type));
+                    }
+                    // 从快照恢复的条目在第一次命中时才复制出内容, 映射由 snapshot 保持有效
+                    snapshot = it->second.snapshot;
+                    snapshot_data = it->second.snapshot_data;
+                    snapshot_size = it->second.file_size;
+                    mime_type = it->second.mime_type;
+                }
             } else {
-                // 更新LRU位置
-                lru_list_.erase(it->second.lru_it);
-                lru_list_.push_front(file_path);
-                it->second.lru_it = lru_list_.begin();
-                cache_hits_++;
-                return std::make_optional(std::make_pair(it->second.content, it->second.mime_type));
+                cache_misses_++;
             }
-        } else {
-            cache_misses_++;
         }
 
-        // 加载新文件到缓存
+        if (snapshot) {
+            auto content = materialize(snapshot_data, snapshot_size);
+            std::unique_lock lock = trace::lock(mutex_, "file_cache", "mutex_wait");
+            auto it = cache_.find(file_path);
+            // 复制期间条目可能已经被淘汰、替换或者由其他线程复制过, 只在它还指向同一份快照时写回
+            if (it != cache_.end() && !it->second.content && it->second.snapshot_data == snapshot_data) {
+                it->second.content = content;
+                it->second.snapshot.reset();
+                it->second.snapshot_data = nullptr;
+            }
+            return std::make_optional(std::make_pair(std::move(content), std::move(mime_type)));
+        }
+
+        // 加载新文件; 同一个文件同时未命中时可能被读取多次, 最后放入的为准
         CachedFile new_file;
         if (!load_file(file_path, new_file)) {
             return std::nullopt;
         }
 
+        std::unique_lock lock = trace::lock(mutex_, "file_cache", "mutex_wait");
+        auto it = cache_.find(file_path);
+        if (it != cache_.end()) erase(it);
+
         // 添加新条目
         lru_list_.push_front(file_path);
         new_file.lru_it = lru_list_.begin();
-        cache_.insert_or_assign(file_path, new_file);
+        auto content = new_file.content;
+        mime_type = new_file.mime_type;
         current_size_ += new_file.file_size;
+        cache_.insert_or_assign(file_path, std::move(new_file));
 
         // 清理过期缓存
         while (current_size_ > max_size_) {
             evict();
         }
 
-        return std::make_optional(std::make_pair(new_file.content, new_file.mime_type));
+        return std::make_optional(std::make_pair(std::move(content), std::move(mime_type)));
     }
 
     void set_max_size(size_t max_size) {
@@ -90,42 +145,280 @@ public:
         return cache_misses_;
     }
 
+    //  把所有条目按 LRU 顺序 (最近使用的在前) 写入一个快照文件, 用于重启后预热
+    //  先写临时文件再改名, 写到一半失败不会破坏旧的快照
+    bool save_snapshot(const std::string& snapshot_path) const {
+        struct Item {
+            std::string path;
+            std::string mime_type;
+            time_t last_modified;
+            size_t size;
+            std::shared_ptr<const void> keep_alive; // 写文件时不持锁, 靠它保证内容有效
+            const char* data;
+        };
+        std::vector<Item> items;
+        {
+            std::shared_lock lock(mutex_);
+            items.reserve(lru_list_.size());
+            for (const std::string& path : lru_list_) {
+                auto it = cache_.find(path);
+                if (it == cache_.end()) continue;
+                const CachedFile& file = it->second;
+                if (file.content) {
+                    items.push_back({path, file.mime_type, file.last_modified, file.file_size, file.content, file.content->data()});
+                } else {
+                    items.push_back({path, file.mime_type, file.last_modified, file.file_size, file.snapshot, file.snapshot_data});
+                }
+            }
+        }
+
+        blocking_section blocking;
+        // 布局: 文件头 | 条目表 | 路径和 MIME 字符串 | 按 snapshot_align 对齐的文件内容
+        SnapshotHeader header{};
+        std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+        header.version = snapshot_version;
+        header.byte_order = snapshot_byte_order;
+        header.entry_count = items.size();
+        uint64_t offset = sizeof(SnapshotHeader) + sizeof(SnapshotEntry) * items.size();
+        std::vector<SnapshotEntry> entries(items.size());
+        for (size_t i = 0; i < items.size(); ++i) {
+            entries[i].path_offset = offset;
+            entries[i].path_size = items[i].path.size();
+            offset += items[i].path.size();
+            entries[i].mime_offset = offset;
+            entries[i].mime_size = items[i].mime_type.size();
+            offset += items[i].mime_type.size();
+        }
+        for (size_t i = 0; i < items.size(); ++i) {
+            offset = align_up(offset);
+            entries[i].content_offset = offset;
+            entries[i].content_size = items[i].size;
+            entries[i].last_modified = static_cast<int64_t>(items[i].last_modified);
+            offset += items[i].size;
+        }
+        header.file_size = offset;
+
+        std::string temp_path = snapshot_path + ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return false;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(sizeof(SnapshotEntry) * entries.size()));
+            uint64_t written = sizeof(SnapshotHeader) + sizeof(SnapshotEntry) * entries.size();
+            for (const Item& item : items) {
+                out.write(item.path.data(), static_cast<std::streamsize>(item.path.size()));
+                out.write(item.mime_type.data(), static_cast<std::streamsize>(item.mime_type.size()));
+                written += item.path.size() + item.mime_type.size();
+            }
+            static const char padding[snapshot_align] = {};
+            for (size_t i = 0; i < items.size(); ++i) {
+                out.write(padding, static_cast<std::streamsize>(entries[i].content_offset - written));
+                out.write(items[i].data, static_cast<std::streamsize>(items[i].size));
+                written = entries[i].content_offset + items[i].size;
+            }
+            if (!out.good()) {
+                out.close();
+                std::remove(temp_path.c_str());
+                return false;
+            }
+        }
+        if (std::rename(temp_path.c_str(), snapshot_path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    //  从快照恢复缓存: 只映射文件并建立索引, 内容在第一次命中时才复制出来;
+    //  命中时和普通条目一样检查修改时间, 源文件已更新的条目会被重新加载.
+    //  已经在缓存中的条目保持不变, 超出 max_size 的部分 (最久未使用的) 被丢弃
+    //  返回恢复的条目数, 快照不存在或格式不对时返回 0
+    size_t load_snapshot(const std::string& snapshot_path) {
+        auto mapping = MappedFile::open(snapshot_path);
+        if (!mapping || mapping->size() < sizeof(SnapshotHeader)) return 0;
+        SnapshotHeader header;
+        std::memcpy(&header, mapping->data(), sizeof(header));
+        if (std::memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0 || header.version != snapshot_version
+            || header.byte_order != snapshot_byte_order || header.file_size != mapping->size()
+            || header.entry_count > (mapping->size() - sizeof(SnapshotHeader)) / sizeof(SnapshotEntry)) {
+            return 0;
+        }
+        const char* base = mapping->data();
+        auto in_file = [&](uint64_t offset, uint64_t size) {
+            return offset <= header.file_size && size <= header.file_size - offset;
+        };
+
+        std::unique_lock lock(mutex_);
+        size_t restored = 0;
+        for (uint64_t i = 0; i < header.entry_count; ++i) {
+            SnapshotEntry entry;
+            std::memcpy(&entry, base + sizeof(SnapshotHeader) + i * sizeof(SnapshotEntry), sizeof(entry));
+            if (!in_file(entry.path_offset, entry.path_size) || !in_file(entry.mime_offset, entry.mime_size)
+                || !in_file(entry.content_offset, entry.content_size) || entry.content_size == 0) {
+                break; // 快照损坏, 保留已经恢复的部分
+            }
+            if (current_size_ + entry.content_size > max_size_) break;
+            std::string path(base + entry.path_offset, entry.path_size);
+            if (cache_.find(path) != cache_.end()) continue;
+
+            CachedFile file;
+            file.mime_type.assign(base + entry.mime_offset, entry.mime_size);
+            file.last_modified = static_cast<time_t>(entry.last_modified);
+            file.file_size = entry.content_size;
+            file.snapshot = mapping;
+            file.snapshot_data = base + entry.content_offset;
+            // 快照按最近使用在前的顺序保存, 依次追加到 LRU 列表尾部即可保持顺序
+            lru_list_.push_back(path);
+            file.lru_it = std::prev(lru_list_.end());
+            current_size_ += file.file_size;
+            cache_.insert_or_assign(std::move(path), std::move(file));
+            ++restored;
+        }
+        return restored;
+    }
+
 private:
-    time_t get_file_last_write_time(const std::string& file_path) {
-        struct stat file_stat;
-        if (stat(file_path.c_str(), &file_stat) != 0) {
-            return 0; // 获取文件信息失败
+    // 只读映射整个快照文件; 最后一个引用它的条目被读出或淘汰后解除映射
+    class MappedFile {
+    public:
+        static std::shared_ptr<const MappedFile> open(const std::string& path) {
+            std::shared_ptr<MappedFile> file(new MappedFile());
+#ifndef _WIN32
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return nullptr;
+            struct stat file_stat;
+            if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+                ::close(fd);
+                return nullptr;
+            }
+            void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd); // 映射建立后就不再需要文件描述符
+            if (data == MAP_FAILED) return nullptr;
+            file->data_ = static_cast<const char*>(data);
+            file->size_ = static_cast<size_t>(file_stat.st_size);
+#else
+            // 没有 mmap 时整个读入内存
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in.is_open()) return nullptr;
+            file->buffer_.resize(static_cast<size_t>(in.tellg()));
+            in.seekg(0);
+            in.read(file->buffer_.data(), static_cast<std::streamsize>(file->buffer_.size()));
+            file->data_ = file->buffer_.data();
+            file->size_ = static_cast<size_t>(in.gcount());
+#endif
+            return file;
         }
-        return file_stat.st_mtime; // 获取文件的最后修改时间
+
+        ~MappedFile() {
+#ifndef _WIN32
+            if (data_) munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        MappedFile() = default;
+
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        std::vector<char> buffer_;
+#endif
+    };
+
+    // 快照文件格式, 按本机字节序保存, 只用于同一类机器之间
+    static constexpr char snapshot_magic[8] = {'M', 'S', 'T', 'D', 'F', 'C', 'S', 'P'};
+    static constexpr uint32_t snapshot_version = 1;
+    static constexpr uint32_t snapshot_byte_order = 0x01020304;
+    static constexpr uint64_t snapshot_align = 64; // 文件内容按缓存行对齐
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t entry_count;
+        uint64_t file_size; // 整个快照文件的大小, 用于检查是否被截断
+        uint64_t reserved[4];
+    };
+
+    struct SnapshotEntry {
+        uint64_t content_offset;
+        uint64_t content_size;
+        int64_t last_modified;
+        uint64_t path_offset;
+        uint64_t mime_offset;
+        uint32_t path_size;
+        uint32_t mime_size;
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 64, "unexpected snapshot header layout");
+    static_assert(sizeof(SnapshotEntry) == 48, "unexpected snapshot entry layout");
+
+    static uint64_t align_up(uint64_t offset) {
+        return (offset + snapshot_align - 1) & ~(snapshot_align - 1);
+    }
+
+    //  把快照中的内容复制出来, 调用时不持有锁
+    static std::shared_ptr<const std::vector<char>> materialize(const char* data, size_t size) {
+        blocking_section blocking; // 映射的页面可能还在磁盘上
+        return std::make_shared<const std::vector<char>>(data, data + size);
     }
 
-    size_t get_file_size(const std::string& file_path) {
+    //  移到 LRU 列表头部, 需要持有锁
+    void touch(CachedFile& file, const std::string& file_path) {
+        lru_list_.erase(file.lru_it);
+        lru_list_.push_front(file_path);
+        file.lru_it = lru_list_.begin();
+    }
+
+    //  移除一个条目, 需要持有锁
+    void erase(std::unordered_map<std::string, CachedFile, mstd::string_hash>::iterator it) {
+        current_size_ -= it->second.file_size;
+        lru_list_.erase(it->second.lru_it);
+        cache_.erase(it);
+    }
+
+    //  获取文件的修改时间和大小, 失败时返回 false
+    static bool stat_file(const std::string& file_path, time_t& last_modified, size_t& file_size) {
         struct stat file_stat;
-        if (stat(file_path.c_str(), &file_stat) != 0) {
-            return 0; // 获取文件信息失败
-        }
-        return file_stat.st_size; // 获取文件大小
+        if (stat(file_path.c_str(), &file_stat) != 0) return false;
+        last_modified = file_stat.st_mtime;
+        file_size = static_cast<size_t>(file_stat.st_size);
+        return true;
     }
 
-    //  查看文件是否已经修改
-    bool is_file_modified(const std::string& file_path, time_t cached_time) {
-        return get_file_last_write_time(file_path) > cached_time; // 检查文件是否已修改
+    //  查看文件是否已经修改: 修改时间或大小与缓存时不同都算 (修改时间倒退也算, 例如从备份恢复);
+    //  文件已经无法访问 (被删除、没有权限) 时同样返回 true, 条目会被移除
+    bool is_file_modified(const std::string& file_path, const CachedFile& file) {
+        time_t last_modified;
+        size_t file_size;
+        if (!stat_file(file_path, last_modified, file_size)) return true;
+        return last_modified != file.last_modified || file_size != file.file_size;
     }
 
-    //  加载文件内容
+    //  加载文件内容, 调用时不持有锁
     bool load_file(const std::string& file_path, CachedFile& result) {
-        std::ifstream file(file_path, std::ios::binary | std::ios::ate); // 以二进制方式打开文件，并定位到文件末尾
+        blocking_section blocking; // 在线程池中调用时, 读盘期间让线程池补充一个线程
+        trace::Scope scope("file_cache", "load_file");
+        std::ifstream file(file_path, std::ios::binary);
         if (!file.is_open()) return false;
+        // 修改时间和大小在读取之前取一次, 读取期间文件被修改时下一次命中会发现并重新加载
+        time_t last_modified;
+        size_t file_size;
+        if (!stat_file(file_path, last_modified, file_size) || file_size == 0) return false;
 
-        auto file_size = get_file_size(file_path); // 获取文件大小
-        if (file_size == 0) return false;
+        auto content = std::make_shared<std::vector<char>>(file_size);
+        file.read(content->data(), static_cast<std::streamsize>(content->size()));
+        if (static_cast<size_t>(file.gcount()) != file_size) return false; // 读取期间文件被截断
+        result.content = std::move(content);
 
-        result.content.resize(file_size); // 调整内容缓冲区大小
-        file.seekg(0); // 定位到文件开头
-        file.read(result.content.data(), result.content.size()); // 读取文件内容
-        
         result.file_size = file_size;
-        result.last_modified = get_file_last_write_time(file_path); // 获取文件的最后修改时间
+        result.last_modified = last_modified;
         result.mime_type = get_mime_type(file_path); // 获取文件的MIME类型
         return true;
     }
@@ -173,7 +466,7 @@ private:
     size_t max_size_; // 最大缓存大小
     size_t current_size_; // 当前缓存大小
     std::list<std::string> lru_list_; // LRU列表    Least Recently Used，最近最少使用
-    std::unordered_map<std::string, CachedFile> cache_; // 文件缓存
+    std::unordered_map<std::string, CachedFile, mstd::string_hash> cache_; // 文件缓存, 使用 SIMD 哈希
     mutable std::shared_mutex mutex_; // 读写锁
     size_t cache_hits_; // 缓存命中次数
     size_t cache_misses_; // 缓存未命中次数
@@ -1,33 +1,68 @@
 #pragma once
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <thread>
+#include <cstdint>
+#include <stdexcept>
+#include "trace.hpp"
 
 namespace mstd {
 
+/// @brief 多生产者多消费者的无锁队列 (Michael-Scott 队列)
+/// 节点放在只增不减的节点池里, 出队后的节点进入空闲链表复用, 在队列析构前不会释放,
+/// 所以其他线程读到一个已经出队的节点也不会访问到已释放的内存;
+/// 头、尾和 next 都是 (节点下标, 版本号) 打包成的 64 位整数, 版本号用来避免 ABA 问题
 template <typename T>
 class LockFreeQueue {
 private:
+    static constexpr std::uint32_t nil = 0xFFFFFFFFu;
+    static constexpr std::uint32_t firstBlock = 64; // 第 k 块有 firstBlock << k 个节点
+    static constexpr int maxBlocks = 26;
+
     struct Node {
-        std::shared_ptr<T> data;
-        Node* next;
-        template <typename U>
-        Node(U&& value) : data(std::make_shared<T>(std::forward<U>(value))), next(nullptr) {}
+        std::atomic<std::uint64_t> next{pack(nil, 0)}; // 在空闲链表中时指向下一个空闲节点
+        std::atomic<T*> data{nullptr};
     };
 
-    std::atomic<Node*> head;
-    std::atomic<Node*> tail;
+    static constexpr std::uint64_t pack(std::uint32_t index, std::uint32_t tag) {
+        return (static_cast<std::uint64_t>(tag) << 32) | index;
+    }
+
+    static std::uint32_t index(std::uint64_t ref) {
+        return static_cast<std::uint32_t>(ref);
+    }
+
+    static std::uint32_t tag(std::uint64_t ref) {
+        return static_cast<std::uint32_t>(ref >> 32);
+    }
+
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+    alignas(64) std::atomic<std::uint64_t> freeList;
+    std::atomic<std::uint32_t> allocated;
+    std::atomic<Node*> blocks[maxBlocks];
+    std::mutex growMutex; // 只在新增节点块时使用
 
 public:
-    LockFreeQueue() : head(new Node(T())), tail(head.load(std::memory_order_relaxed)) {}
+    LockFreeQueue() : freeList(pack(nil, 0)), allocated(0) {
+        for (auto& block : blocks) block.store(nullptr, std::memory_order_relaxed);
+        std::uint32_t dummy = allocate();
+        head.store(pack(dummy, 0), std::memory_order_relaxed);
+        tail.store(pack(dummy, 0), std::memory_order_relaxed);
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
 
     /// @brief 析构函数, 释放内存
     ~LockFreeQueue() {
-        while (Node* old_head = head.load(std::memory_order_relaxed)) {
-            head.store(old_head->next, std::memory_order_relaxed);
-            delete old_head;
+        for (std::uint32_t i = index(node(index(head.load(std::memory_order_relaxed))).next.load(std::memory_order_relaxed)); i != nil;
+             i = index(node(i).next.load(std::memory_order_relaxed))) {
+            delete node(i).data.load(std::memory_order_relaxed);
         }
+        for (auto& block : blocks) delete[] block.load(std::memory_order_relaxed);
     }
 
     /// @brief 入无锁队列
@@ -35,35 +70,101 @@ public:
     /// @param value 入队数据
     template <typename U>
     void enqueue(U&& value) {
-        Node* new_node = new Node(std::forward<U>(value));
-        Node* old_tail = tail.load(std::memory_order_relaxed);
-        while (!tail.compare_exchange_weak(old_tail, new_node, std::memory_order_release, std::memory_order_relaxed)) {
-            old_tail = tail.load(std::memory_order_relaxed);
+        std::unique_ptr<T> data(new T(std::forward<U>(value)));
+        std::uint32_t n = allocate();
+        Node& fresh = node(n);
+        fresh.data.store(data.release(), std::memory_order_relaxed);
+        fresh.next.store(pack(nil, tag(fresh.next.load(std::memory_order_relaxed)) + 1), std::memory_order_relaxed);
+        for (;;) {
+            std::uint64_t last = tail.load(std::memory_order_acquire);
+            std::uint64_t next = node(index(last)).next.load(std::memory_order_acquire);
+            if (last != tail.load(std::memory_order_acquire)) continue;
+            if (index(next) == nil) {
+                // 把新节点接到队尾, 成功后再尝试移动 tail (失败说明已经有别的线程帮忙移动了)
+                if (node(index(last)).next.compare_exchange_weak(next, pack(n, tag(next) + 1), std::memory_order_release, std::memory_order_relaxed)) {
+                    tail.compare_exchange_strong(last, pack(n, tag(last) + 1), std::memory_order_release, std::memory_order_relaxed);
+                    return;
+                }
+            } else {
+                // tail 落后了, 帮忙往后移动
+                tail.compare_exchange_weak(last, pack(index(next), tag(last) + 1), std::memory_order_release, std::memory_order_relaxed);
+            }
         }
-        old_tail->next = new_node;
     }
 
     bool empty() const {
-        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        std::uint64_t first = head.load(std::memory_order_acquire);
+        return index(node(index(first)).next.load(std::memory_order_acquire)) == nil;
     }
 
     /// @brief 出无锁队列
-    /// @return std::shared_ptr<T> 出队数据
+    /// @return std::shared_ptr<T> 出队数据, 队列为空时返回空指针
     std::shared_ptr<T> dequeue() {
-        Node* old_head = head.load(std::memory_order_acquire);
-        while (old_head != tail.load(std::memory_order_acquire) && !head.compare_exchange_weak(old_head, old_head->next, std::memory_order_release, std::memory_order_relaxed)) {
+        std::int64_t retries = 0; // CAS 失败的次数, 开启跟踪时记录
+        for (;; ++retries) {
+            std::uint64_t first = head.load(std::memory_order_acquire);
+            std::uint64_t last = tail.load(std::memory_order_acquire);
+            std::uint64_t next = node(index(first)).next.load(std::memory_order_acquire);
+            if (first != head.load(std::memory_order_acquire)) continue;
+            if (index(first) == index(last)) {
+                // 这里判断下是否为空
+                if (index(next) == nil) {
+                    if (retries) trace::instant("lock_free_queue", "dequeue_retry", "retries", retries);
+                    return std::shared_ptr<T>();
+                }
+                tail.compare_exchange_weak(last, pack(index(next), tag(last) + 1), std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if (index(next) == nil) continue; // 读到的是过期的值
+            // 先读出数据指针再移动 head; head 移动成功后数据只属于当前线程
+            T* data = node(index(next)).data.load(std::memory_order_acquire);
+            if (head.compare_exchange_weak(first, pack(index(next), tag(first) + 1), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                release(index(first)); // 旧的哑节点
+                if (retries) trace::instant("lock_free_queue", "dequeue_retry", "retries", retries);
+                return std::shared_ptr<T>(data);
+            }
             std::this_thread::yield();
-            old_head = head.load(std::memory_order_acquire);
         }
-        // 这里判断下是否为空
-        if (old_head == tail.load(std::memory_order_acquire)) {
-            return std::shared_ptr<T>();
+    }
+
+private:
+    Node& node(std::uint32_t i) const {
+        // 下标 i 位于第 k 块, k = floor(log2(i / firstBlock + 1))
+        std::uint32_t scaled = i / firstBlock + 1;
+        int k = 31 - __builtin_clz(scaled);
+        std::uint32_t offset = i - firstBlock * ((1u << k) - 1);
+        return blocks[k].load(std::memory_order_acquire)[offset];
+    }
+
+    std::uint32_t allocate() {
+        // 先从空闲链表中取
+        std::uint64_t top = freeList.load(std::memory_order_acquire);
+        while (index(top) != nil) {
+            std::uint64_t next = node(index(top)).next.load(std::memory_order_relaxed);
+            if (freeList.compare_exchange_weak(top, pack(index(next), tag(top) + 1), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return index(top);
+            }
+        }
+        std::uint32_t i = allocated.fetch_add(1, std::memory_order_relaxed);
+        std::uint32_t k = 31 - __builtin_clz(i / firstBlock + 1);
+        if (k >= static_cast<std::uint32_t>(maxBlocks)) throw std::length_error("LockFreeQueue: too many nodes");
+        if (!blocks[k].load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(growMutex);
+            if (!blocks[k].load(std::memory_order_relaxed)) {
+                blocks[k].store(new Node[static_cast<size_t>(firstBlock) << k], std::memory_order_release);
+            }
         }
-        std::shared_ptr<T> res = old_head->next->data;
-        Node* new_head = old_head->next;
-        head.store(new_head, std::memory_order_relaxed);
-        delete old_head;
-        return res;
+        return i;
+    }
+
+    void release(std::uint32_t i) {
+        Node& n = node(i);
+        // next 的版本号继续递增, 还拿着旧值的线程 CAS 会失败
+        std::uint32_t nextTag = tag(n.next.load(std::memory_order_relaxed)) + 1;
+        std::uint64_t top = freeList.load(std::memory_order_relaxed);
+        do {
+            n.next.store(pack(index(top), nextTag), std::memory_order_relaxed);
+        } while (!freeList.compare_exchange_weak(top, pack(i, tag(top) + 1), std::memory_order_release, std::memory_order_relaxed));
     }
 };
-}
\ No newline at end of file
+}
@@ -5,40 +5,64 @@
 #include <future>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <iostream>
+#include <list>
+#include <stdexcept>
+#include <algorithm>
 #include "function.hpp"
+#include "TimingWheel.hpp"
+#include "trace.hpp"
 
 namespace mstd {
 
 class ThreadPool {
 public:
-    /// @brief 创建线程池
+    using TimerId = TimingWheel::TimerId;
+
+    /// @brief 创建固定大小的线程池
     /// @param numThreads 线程池的线程数量 
-    ThreadPool(size_t numThreads): _stop(false) {
-        for (size_t i = 0; i < numThreads; ++i) {
-            _workers.emplace_back([this] {
-                for (;;) {
-                    mstd::Function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(this->_queueMutex);
-                        this->_condition.wait(lock, [this] { return this->_stop.load() || !this->_tasks.empty(); });
-                        if (this->_stop.load() && this->_tasks.empty()) return;
-                        task = std::move(this->_tasks.front());
-                        this->_tasks.pop();
-                    }
-                    task();
-                }
-            });
+    ThreadPool(size_t numThreads) : ThreadPool(numThreads, numThreads) {}
+
+    /// @brief 创建可伸缩的线程池
+    /// 队列中的任务等待时间超过 growAfterWait 且没有空闲线程时增加线程, 最多 maxThreads 个;
+    /// 超过 minThreads 的线程空闲 idleTimeout 后退出
+    /// @param minThreads 最少线程数
+    /// @param maxThreads 最多线程数 (不含 blocking_section 临时补充的线程)
+    /// @param idleTimeout 多余线程的空闲超时时间
+    ThreadPool(size_t minThreads, size_t maxThreads, std::chrono::milliseconds idleTimeout = std::chrono::seconds(30))
+        : _stop(false), _minThreads(minThreads), _maxThreads(maxThreads), _idleTimeout(idleTimeout) {
+        if (minThreads > maxThreads) throw std::invalid_argument("ThreadPool: minThreads > maxThreads");
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        for (size_t i = 0; i < minThreads; ++i) {
+            spawn();
         }
     }
 
     ~ThreadPool(){
-        _stop.store(true);
+        {
+            // 在锁内设置, 之后不会再有线程被创建或者退休
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _stop.store(true);
+        }
+        {
+            std::lock_guard<std::mutex> lock(_timerMutex);
+        }
+        _timerCondition.notify_all();
+        if (_timerThread.joinable()) {
+            _timerThread.join();
+        }
         _condition.notify_all();
         for (std::thread& worker : _workers) {
             if (worker.joinable()) {
                 worker.join();
             }
         }
+        for (std::thread& worker : _retired) {
+            worker.join();
+        }
     }
 
     /// @brief 添加任务到线程池
@@ -53,21 +77,339 @@ public:
     
         auto task = std::make_shared<std::packaged_task<returnType()>>(mstd::bind(std::forward<F>(f), std::forward<Args>(args)...));
         std::future<returnType> res = task->get_future();
+        if (push([task]() { (*task)(); }, "enqueue on stopped ThreadPool")) watchGrowth();
+        return res;
+    }
+
+    /// @brief 当前的线程数量 (包括临时补充的线程)
+    size_t thread_count() const {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        return _threads;
+    }
+
+    /// @brief 队列中等待执行的任务数量
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        return _tasks.size();
+    }
+
+    /// @brief 队列中的任务等待超过这个时间时才考虑增加线程
+    static constexpr std::chrono::milliseconds growAfterWait{1};
+
+    /// @brief 延迟执行任务, 到期后放入线程池的任务队列
+    /// @param delay 延迟时间, 精度为 1 毫秒
+    /// @param f 任务, 没有返回值; 抛出的异常会被打印并忽略
+    /// @return 定时器编号, 可以用 cancel 取消
+    template <class Rep, class Period, class F>
+    TimerId schedule_after(std::chrono::duration<Rep, Period> delay, F&& f) {
+        auto task = std::make_shared<mstd::Function<void()>>(typename std::decay<F>::type(std::forward<F>(f)));
+        return addTimer(toTicks(delay), std::move(task), 0);
+    }
+
+    /// @brief 周期执行任务, 第一次在一个周期之后; 上一次还没执行完时跳过本次, 不会并发执行
+    /// @param period 周期, 精度为 1 毫秒
+    /// @param f 任务
+    /// @return 定时器编号, 可以用 cancel 取消
+    template <class Rep, class Period, class F>
+    TimerId schedule_every(std::chrono::duration<Rep, Period> period, F&& f) {
+        std::uint64_t ticks = std::max<std::uint64_t>(toTicks(period), 1);
+        auto busy = std::make_shared<std::atomic<bool>>(false);
+        auto task = std::make_shared<mstd::Function<void()>>(
+            [fn = typename std::decay<F>::type(std::forward<F>(f)), busy]() {
+                if (busy->exchange(true)) return;
+                struct Reset {
+                    std::atomic<bool>& flag;
+                    ~Reset() { flag.store(false); }
+                } reset{*busy};
+                fn();
+            });
+        return addTimer(ticks, std::move(task), ticks);
+    }
+
+    /// @brief 取消定时器; 已经放入任务队列的那一次仍会执行
+    /// @return 定时器还在等待时返回 true
+    bool cancel(TimerId id) {
+        std::lock_guard<std::mutex> lock(_timerMutex);
+        return _timers.cancel(id);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    template <class Rep, class Period>
+    static std::uint64_t toTicks(std::chrono::duration<Rep, Period> d) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(d);
+        if (ms < d) ++ms; // 向上取整, 不会提前触发
+        return ms.count() > 0 ? static_cast<std::uint64_t>(ms.count()) : 0;
+    }
+
+    std::uint64_t currentTick() const {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _timerEpoch).count());
+    }
+
+    TimerId addTimer(std::uint64_t delay, TimingWheel::Task task, std::uint64_t period) {
+        std::lock_guard<std::mutex> lock(_timerMutex);
+        if (_stop.load()) throw std::runtime_error("schedule on stopped ThreadPool");
+        // currentTick() 向下取整, 当前 tick 可能已经过去了一部分, 多等一个 tick 才不会提前触发
+        std::uint64_t expires = currentTick() + delay + (delay > 0 ? 1 : 0);
+        TimerId id = _timers.add(expires, std::move(task), period);
+        wakeTimerAt(expires);
+        return id;
+    }
+
+    // 需要持有 _timerMutex; 第一次使用时才启动计时线程, 只有比它当前的唤醒时间更早时才需要叫醒它
+    void wakeTimerAt(std::uint64_t tick) {
+        if (!_timerThread.joinable()) {
+            _timerThread = std::thread([this] { timerLoop(); });
+        }
+        if (tick < _timerWake) {
+            _timerWake = tick;
+            _timerCondition.notify_one();
+        }
+    }
+
+    // 任务积压而所有线程都在忙或者阻塞时, 不会再有出队触发 maybeGrow, 入队也可能就此停止;
+    // 这时让计时线程每隔 growAfterWait 检查一次, 直到积压消失或者线程数到达上限
+    void watchGrowth() {
+        std::lock_guard<std::mutex> lock(_timerMutex);
+        armGrowthCheck();
+    }
+
+    // 需要持有 _timerMutex
+    void armGrowthCheck() {
+        if (_stop.load()) return;
+        _growCheckAt = currentTick() + static_cast<std::uint64_t>(growAfterWait.count());
+        wakeTimerAt(_growCheckAt);
+    }
+
+    // 由计时线程调用; 返回是否还需要继续检查
+    bool checkGrowth() {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        maybeGrow();
+        _growWatched = growthStalled();
+        return _growWatched;
+    }
+
+    // 需要持有 _queueMutex; 积压停滞而计时线程还没有在检查时返回 true
+    bool startGrowthWatch() {
+        if (_growWatched || !growthStalled()) return false;
+        _growWatched = true;
+        return true;
+    }
+
+    // 需要持有 _queueMutex; 弹性线程池有积压、没有空闲线程、还能增加线程
+    bool growthStalled() const {
+        return _minThreads < _maxThreads && !_stop.load() && !_tasks.empty() && _idle == 0
+            && _threads - _blocked < _maxThreads;
+    }
+
+    // 计时线程: 推进时间轮, 把到期的任务放入任务队列, 然后睡到下一个需要处理的时间
+    void timerLoop() {
+        std::unique_lock<std::mutex> lock(_timerMutex);
+        while (!_stop.load()) {
+            std::uint64_t now = currentTick();
+            _timers.advance(now, [this](const TimingWheel::Task& task) { dispatch(task); });
+            if (now >= _growCheckAt) {
+                _growCheckAt = checkGrowth() ? now + static_cast<std::uint64_t>(growAfterWait.count()) : UINT64_MAX;
+            }
+            std::uint64_t wait = _timers.ticksUntilNext();
+            _timerWake = std::min(_growCheckAt, wait == UINT64_MAX ? UINT64_MAX : _timers.now() + wait);
+            if (_timerWake == UINT64_MAX) {
+                _timerCondition.wait(lock);
+            } else {
+                _timerCondition.wait_until(lock, _timerEpoch + std::chrono::milliseconds(_timerWake));
+            }
+        }
+    }
+
+    // 在计时线程中调用, 已经持有 _timerMutex
+    void dispatch(const TimingWheel::Task& task) {
+        // 定时任务没有 future 可以传递异常, 这里捕获, 避免工作线程因此退出
+        bool watch = push([task]() {
+            try {
+                (*task)();
+            } catch (const std::exception& e) {
+                std::cerr << "[ThreadPool] scheduled task threw: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "[ThreadPool] scheduled task threw an unknown exception" << std::endl;
+            }
+        }, nullptr);
+        if (watch) armGrowthCheck();
+    }
+
+    friend class blocking_section;
+
+    struct QueuedTask {
+        mstd::Function<void()> run;
+        Clock::time_point enqueued; // 用于计算排队时间
+    };
+
+    // 当前线程所属的线程池, 不是工作线程时为空
+    static ThreadPool*& currentPool() {
+        thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    // 返回 true 时调用方需要在释放 _queueMutex 之后让计时线程开始检查 (watchGrowth / armGrowthCheck);
+    // 计时线程持有 _timerMutex 时会调用 push, 所以这里不能反过来在持有 _queueMutex 时获取 _timerMutex
+    template <class F>
+    bool push(F&& run, const char* stoppedError) {
+        bool watch = false;
         {
             std::unique_lock<std::mutex> lock(_queueMutex);
-            if (_stop.load()) throw std::runtime_error("enqueue on stopped ThreadPool");
-            _tasks.emplace([task]() { (*task)(); });
+            if (_stop.load()) {
+                if (stoppedError) throw std::runtime_error(stoppedError);
+                return false; // 正在析构, 丢弃定时任务
+            }
+            // 固定大小的线程池不需要排队时间 (除非开启了跟踪), 省掉一次取时间
+            Clock::time_point now = _minThreads < _maxThreads || trace::enabled ? Clock::now() : Clock::time_point();
+            _tasks.push(QueuedTask{mstd::Function<void()>(std::forward<F>(run)), now});
+            trace::counter("thread_pool", "queue_depth", static_cast<std::int64_t>(_tasks.size()));
+            maybeGrow();
+            watch = startGrowthWatch();
         }
         _condition.notify_one();
-        return res;
+        return watch;
     }
 
-private:
-    std::vector<std::thread> _workers;
-    std::queue<mstd::Function<void()>> _tasks;
+    // 需要持有 _queueMutex; 新线程的迭代器在线程启动前就已经确定
+    void spawn() {
+        for (std::thread& worker : _retired) {
+            worker.join(); // 已经退休的线程在交出锁之后就结束了, 这里不会等待
+        }
+        _retired.clear();
+        _workers.emplace_back();
+        auto self = std::prev(_workers.end());
+        *self = std::thread([this, self] { workerLoop(self); });
+        ++_threads;
+    }
+
+    // 需要持有 _queueMutex. 被阻塞的线程不算在容量内:
+    // 能运行的线程少于 minThreads (或者一个都没有) 时立即补充, 少于 maxThreads 且任务排队太久时增加.
+    // 在入队、出队和进入阻塞区时检查; 积压期间没有这些事件时由计时线程定期检查 (见 watchGrowth)
+    void maybeGrow() {
+        if (_stop.load() || _tasks.empty() || _idle > 0) return;
+        size_t running = _threads - _blocked;
+        if (running < _minThreads || (running < _maxThreads && (running == 0 || Clock::now() - _tasks.front().enqueued >= growAfterWait))) {
+            spawn();
+        }
+    }
+
+    // 需要持有 _queueMutex; 把自己移到 _retired, 由之后创建线程或析构的线程 join
+    void retire(std::list<std::thread>::iterator self) {
+        --_threads;
+        _retired.splice(_retired.end(), _workers, self);
+    }
 
-    std::mutex _queueMutex;
+    void workerLoop(std::list<std::thread>::iterator self) {
+        currentPool() = this;
+        trace::set_thread_name("mstd::ThreadPool worker");
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        for (;;) {
+            while (_tasks.empty() && !_stop.load()) {
+                size_t running = _threads - _blocked;
+                // 补充的线程在被阻塞的线程回来后立即退出
+                if (running > _maxThreads) {
+                    retire(self);
+                    return;
+                }
+                ++_idle;
+                bool timedOut = false;
+                if (running > _minThreads) {
+                    timedOut = !_condition.wait_for(lock, _idleTimeout, [this] { return _stop.load() || !_tasks.empty(); });
+                } else {
+                    _condition.wait(lock, [this] { return _stop.load() || !_tasks.empty(); });
+                }
+                --_idle;
+                if (timedOut && _threads - _blocked > _minThreads) {
+                    retire(self);
+                    return;
+                }
+            }
+            if (_tasks.empty()) return; // 析构中, 由析构函数 join
+            QueuedTask task = std::move(_tasks.front());
+            _tasks.pop();
+            trace::counter("thread_pool", "queue_depth", static_cast<std::int64_t>(_tasks.size()));
+            if (!_tasks.empty()) maybeGrow();
+            lock.unlock();
+            {
+                trace::Scope scope("thread_pool", "task");
+                if constexpr (trace::enabled) {
+                    scope.arg("wait_ns", std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - task.enqueued).count());
+                }
+                task.run();
+            }
+            lock.lock();
+        }
+    }
+
+    // 当前线程进入阻塞区, 由 blocking_section 调用
+    void beginBlocking() {
+        bool watch = false;
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            ++_blocked;
+            maybeGrow();
+            watch = startGrowthWatch();
+        }
+        if (watch) watchGrowth();
+    }
+
+    void endBlocking() {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        --_blocked;
+    }
+
+    // 以下由 _queueMutex 保护
+    std::list<std::thread> _workers;
+    std::list<std::thread> _retired; // 已经退出、还没有 join 的线程
+    std::queue<QueuedTask> _tasks;
+    size_t _threads = 0; // 存活的线程数
+    size_t _idle = 0;    // 正在等待任务的线程数
+    size_t _blocked = 0; // 处于 blocking_section 中的线程数
+    bool _growWatched = false; // 计时线程正在定期检查是否需要增加线程
+
+    mutable std::mutex _queueMutex;
     std::condition_variable _condition;
     std::atomic<bool> _stop;
+    const size_t _minThreads;
+    const size_t _maxThreads;
+    const std::chrono::milliseconds _idleTimeout;
+
+    // 定时器, 全部由 _timerMutex 保护
+    const Clock::time_point _timerEpoch = Clock::now();
+    TimingWheel _timers;
+    std::mutex _timerMutex;
+    std::condition_variable _timerCondition;
+    std::thread _timerThread;
+    std::uint64_t _timerWake = UINT64_MAX; // 计时线程下一次醒来的 tick
+    std::uint64_t _growCheckAt = UINT64_MAX; // 下一次检查是否需要增加线程的 tick
 };
+
+/// @brief 标记一段会阻塞的代码 (磁盘 IO、等待锁等)
+/// 在线程池的工作线程中使用时, 阻塞期间线程池可以临时补充一个线程, 避免队列中的任务空等;
+/// 在其他线程中使用时不做任何事. 可以嵌套, 只有最外层生效
+class blocking_section {
+public:
+    blocking_section() : pool_(depth()++ == 0 ? ThreadPool::currentPool() : nullptr) {
+        if (pool_) pool_->beginBlocking();
+    }
+
+    ~blocking_section() {
+        if (pool_) pool_->endBlocking();
+        --depth();
+    }
+
+    blocking_section(const blocking_section&) = delete;
+    blocking_section& operator=(const blocking_section&) = delete;
+
+private:
+    static int& depth() {
+        thread_local int value = 0;
+        return value;
+    }
+
+    ThreadPool* pool_;
+};
+
 }
@@ -0,0 +1,291 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "function.hpp"
+
+namespace mstd {
+
+/// @brief 分层时间轮, 插入和取消都是 O(1)
+/// 第 0 层 256 个槽, 每槽 1 个 tick; 之后 4 层各 64 个槽, 每层的一个槽等于下一层转一圈.
+/// 高层的槽在低层转完一圈时整体下放 (cascade), 每个定时器最多被下放 4 次.
+/// 定时器节点放在一个数组里, 槽内用下标组成侵入式双向链表, 不为每个定时器单独分配链表节点.
+/// 每个槽是否为空记录在位图中, advance 直接跳到下一个有定时器到期或者需要下放的 tick,
+/// 长时间没有推进 (或者时间轮为空) 之后追赶的代价与经过的 tick 数无关.
+/// 本身不是线程安全的, 由使用者加锁
+class TimingWheel {
+public:
+    /// @brief 定时器编号, 高 32 位是节点的代数, 低 32 位是节点下标; 0 不是有效的编号
+    using TimerId = std::uint64_t;
+    using Task = std::shared_ptr<mstd::Function<void()>>;
+
+    static constexpr TimerId invalidTimer = 0;
+
+    /// @param startTick 起始时间 (tick)
+    explicit TimingWheel(std::uint64_t startTick = 0)
+        : now_(startTick), size_(0), freeList_(noIndex), heads_(slotCount, noIndex), busy_{} {}
+
+    /// @brief 添加定时器
+    /// @param expires 到期时间 (tick), 早于当前时间时在下一次 advance 时触发
+    /// @param task 到期时交给 advance 回调的任务
+    /// @param period 周期 (tick), 0 表示只触发一次
+    /// @return 定时器编号
+    TimerId add(std::uint64_t expires, Task task, std::uint64_t period = 0) {
+        std::uint32_t index = allocate();
+        Node& node = nodes_[index];
+        node.expires = std::max(expires, now_);
+        node.period = period;
+        node.task = std::move(task);
+        link(index);
+        ++size_;
+        return (static_cast<TimerId>(node.generation) << 32) | index;
+    }
+
+    /// @brief 取消定时器
+    /// @return 定时器还没有触发 (周期定时器: 还没有被取消) 时返回 true
+    bool cancel(TimerId id) {
+        std::uint32_t index = static_cast<std::uint32_t>(id);
+        if (index >= nodes_.size()) return false;
+        Node& node = nodes_[index];
+        if (node.generation != static_cast<std::uint32_t>(id >> 32) || node.slot == noIndex) return false;
+        unlink(index);
+        release(index);
+        --size_;
+        return true;
+    }
+
+    /// @brief 推进到 tick (包含), 依次处理到期的定时器
+    /// @param tick 目标时间
+    /// @param onExpire 到期回调, 参数为 const Task&; 回调中不能再访问时间轮
+    template <typename F>
+    void advance(std::uint64_t tick, F&& onExpire) {
+        while (now_ <= tick) {
+            // 跳过既没有定时器到期也不需要下放的 tick; 时间轮为空时直接到 tick 之后
+            std::uint64_t next = nextBusy();
+            if (next > tick) {
+                now_ = tick + 1;
+                break;
+            }
+            now_ = next;
+            std::uint32_t slot = static_cast<std::uint32_t>(now_ & (rootSlots - 1));
+            if (slot == 0) cascade();
+            // 先把整条链表摘下来再处理, 周期定时器重新插入时不会影响遍历
+            std::uint32_t index = heads_[slot];
+            heads_[slot] = noIndex;
+            unmark(slot);
+            while (index != noIndex) {
+                Node& node = nodes_[index];
+                std::uint32_t next = node.next;
+                node.slot = noIndex;
+                if (node.expires > now_) {
+                    // 超出时间轮范围的定时器, 还没到真正的到期时间
+                    link(index);
+                } else if (node.period > 0) {
+                    onExpire(static_cast<const Task&>(node.task));
+                    // 固定频率; 落后太多时跳过错过的周期, 不补发
+                    node.expires += node.period * ((now_ - node.expires) / node.period + 1);
+                    link(index);
+                } else {
+                    Task task = std::move(node.task);
+                    release(index);
+                    --size_;
+                    onExpire(static_cast<const Task&>(task));
+                }
+                index = next;
+            }
+            ++now_;
+        }
+    }
+
+    /// @brief 距离下一次需要调用 advance 的 tick 数 (可能只是一次下放, 并没有定时器到期)
+    /// 时间轮为空时返回 UINT64_MAX
+    std::uint64_t ticksUntilNext() const {
+        std::uint64_t next = nextBusy();
+        return next == UINT64_MAX ? UINT64_MAX : next - now_;
+    }
+
+    /// @brief 下一个还没有处理的 tick
+    std::uint64_t now() const {
+        return now_;
+    }
+
+    /// @brief 等待中的定时器数量
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+private:
+    static constexpr std::uint32_t noIndex = 0xFFFFFFFFu;
+    static constexpr int rootBits = 8;
+    static constexpr int levelBits = 6;
+    static constexpr int levels = 5;
+    static constexpr std::uint32_t rootSlots = 1u << rootBits;
+    static constexpr std::uint32_t levelSlots = 1u << levelBits;
+    static constexpr std::uint64_t maxSpan = (1ull << (rootBits + levelBits * (levels - 1))) - 1;
+    static constexpr std::uint32_t slotCount = rootSlots + levelSlots * (levels - 1);
+    static_assert(levelSlots == 64, "each level above the root is one word of busy_");
+
+    struct Node {
+        std::uint64_t expires = 0;
+        std::uint64_t period = 0;
+        Task task;
+        std::uint32_t prev = noIndex;
+        std::uint32_t next = noIndex; // 空闲时作为空闲链表的指针
+        std::uint32_t slot = noIndex; // 所在的槽, noIndex 表示不在时间轮中
+        std::uint32_t generation = 1;
+    };
+
+    std::uint32_t allocate() {
+        if (freeList_ != noIndex) {
+            std::uint32_t index = freeList_;
+            freeList_ = nodes_[index].next;
+            return index;
+        }
+        if (nodes_.size() >= noIndex) throw std::length_error("TimingWheel: too many timers");
+        nodes_.emplace_back();
+        return static_cast<std::uint32_t>(nodes_.size() - 1);
+    }
+
+    // 代数加一, 之前发出的编号随之失效
+    void release(std::uint32_t index) {
+        Node& node = nodes_[index];
+        node.task.reset();
+        node.slot = noIndex;
+        node.prev = noIndex;
+        node.next = freeList_;
+        if (++node.generation == 0) node.generation = 1;
+        freeList_ = index;
+    }
+
+    // 与 Linux 内核早期的 timer wheel 相同: 层数由剩余时间决定, 槽位由到期时间的对应位决定
+    std::uint32_t slotFor(std::uint64_t expires) const {
+        std::uint64_t delta = expires - now_;
+        if (delta > maxSpan) {
+            delta = maxSpan; // 放在最远的位置, 到时候会被重新插入
+            expires = now_ + delta;
+        }
+        if (delta < rootSlots) {
+            return static_cast<std::uint32_t>(expires & (rootSlots - 1));
+        }
+        int level = 1;
+        while (delta >= (1ull << (rootBits + levelBits * level))) ++level;
+        std::uint64_t slot = (expires >> (rootBits + levelBits * (level - 1))) & (levelSlots - 1);
+        return rootSlots + levelSlots * (level - 1) + static_cast<std::uint32_t>(slot);
+    }
+
+    void link(std::uint32_t index) {
+        Node& node = nodes_[index];
+        std::uint32_t slot = slotFor(node.expires);
+        node.slot = slot;
+        node.prev = noIndex;
+        node.next = heads_[slot];
+        if (node.next != noIndex) nodes_[node.next].prev = index;
+        heads_[slot] = index;
+        mark(slot);
+    }
+
+    void unlink(std::uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != noIndex) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.slot] = node.next;
+            if (node.next == noIndex) unmark(node.slot);
+        }
+        if (node.next != noIndex) nodes_[node.next].prev = node.prev;
+        node.slot = noIndex;
+    }
+
+    void mark(std::uint32_t slot) {
+        busy_[slot >> 6] |= 1ull << (slot & 63);
+    }
+
+    void unmark(std::uint32_t slot) {
+        busy_[slot >> 6] &= ~(1ull << (slot & 63));
+    }
+
+    static std::uint32_t lowestBit(std::uint64_t x) {
+#if defined(__GNUC__)
+        return static_cast<std::uint32_t>(__builtin_ctzll(x));
+#else
+        std::uint32_t n = 0;
+        while (!(x & 1)) {
+            x >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    // 第 0 层中从 from 开始第一个非空的槽, 没有时返回 rootSlots
+    std::uint32_t nextRootSlot(std::uint32_t from) const {
+        for (std::uint32_t word = from >> 6; word < rootSlots / 64; ++word) {
+            std::uint64_t bits = busy_[word];
+            if (word == from >> 6) bits &= ~0ull << (from & 63);
+            if (bits) return word * 64 + lowestBit(bits);
+        }
+        return rootSlots;
+    }
+
+    // 下一个需要处理的 tick (>= now_): 第 0 层有定时器到期, 或者下放时会移动定时器.
+    // 第 level 层的槽 n 只在低位全为 0、对应位等于 n 的 tick 下放, 这时更低的层的槽号都是 0,
+    // cascade 一定会走到这一层; 其余的 tick 上 cascade 什么也不做, 可以跳过.
+    // 时间轮为空时返回 UINT64_MAX
+    std::uint64_t nextBusy() const {
+        if (size_ == 0) return UINT64_MAX;
+        std::uint64_t best = UINT64_MAX;
+        std::uint32_t root = static_cast<std::uint32_t>(now_ & (rootSlots - 1));
+        std::uint32_t slot = nextRootSlot(root);
+        if (slot < rootSlots) {
+            best = now_ - root + slot;
+        } else if ((slot = nextRootSlot(0)) < rootSlots) {
+            best = now_ - root + rootSlots + slot;
+        }
+        for (int level = 1; level < levels; ++level) {
+            std::uint64_t bits = busy_[rootSlots / 64 + level - 1];
+            if (!bits) continue;
+            int shift = rootBits + levelBits * (level - 1);
+            std::uint64_t period = 1ull << (shift + levelBits);
+            std::uint64_t base = now_ & ~(period - 1);
+            // 本圈中还没有下放的第一个槽
+            std::uint64_t first = (now_ - base + (1ull << shift) - 1) >> shift;
+            std::uint64_t ahead = first < levelSlots ? bits & (~0ull << first) : 0;
+            std::uint64_t at = ahead ? base + (static_cast<std::uint64_t>(lowestBit(ahead)) << shift)
+                                     : base + period + (static_cast<std::uint64_t>(lowestBit(bits)) << shift);
+            best = std::min(best, at);
+        }
+        return best;
+    }
+
+    // 第 0 层转完一圈: 把上一层当前槽里的定时器重新插入; 上一层也转完一圈时继续往上
+    void cascade() {
+        for (int level = 1; level < levels; ++level) {
+            std::uint32_t slot = static_cast<std::uint32_t>((now_ >> (rootBits + levelBits * (level - 1))) & (levelSlots - 1));
+            std::uint32_t head = rootSlots + levelSlots * (level - 1) + slot;
+            std::uint32_t index = heads_[head];
+            heads_[head] = noIndex;
+            unmark(head);
+            while (index != noIndex) {
+                std::uint32_t next = nodes_[index].next;
+                link(index);
+                index = next;
+            }
+            if (slot != 0) break;
+        }
+    }
+
+    std::uint64_t now_;
+    std::size_t size_;
+    std::uint32_t freeList_;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> heads_; // 每个槽的链表头
+    std::uint64_t busy_[slotCount / 64]; // 每个槽是否非空
+};
+
+}
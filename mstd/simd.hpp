@@ -0,0 +1,398 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 定义 MSTD_NO_SIMD 可以强制只使用标量实现
+#if !defined(MSTD_NO_SIMD) && defined(__GNUC__) && defined(__SSE2__)
+#define MSTD_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace mstd {
+namespace simd {
+
+static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+/// @brief ASCII 小写转换, 非 ASCII 字节保持不变
+inline unsigned char to_lower(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+// ---------------------------------------------------------------------------
+// 标量实现, 所有平台都可用, 同时负责处理 SIMD 循环剩下的尾部数据
+// ---------------------------------------------------------------------------
+namespace scalar {
+
+// 单字节查找直接用 memchr: libc 的实现已经向量化并按页对齐处理, 比这里的 SSE2/AVX2 循环更快
+inline std::size_t find_char(const char* s, std::size_t n, char c) {
+    if (n == 0) return npos;
+    const void* p = std::memchr(s, c, n);
+    return p ? static_cast<std::size_t>(static_cast<const char*>(p) - s) : npos;
+}
+
+inline std::size_t rfind_char(const char* s, std::size_t n, char c) {
+    while (n > 0) {
+        --n;
+        if (s[n] == c) return n;
+    }
+    return npos;
+}
+
+inline std::size_t find(const char* h, std::size_t hn, const char* nd, std::size_t nn) {
+    if (nn == 0) return 0;
+    if (nn > hn) return npos;
+    const std::size_t last = hn - nn;
+    for (std::size_t i = 0; i <= last; ++i) {
+        std::size_t r = find_char(h + i, last - i + 1, nd[0]);
+        if (r == npos) return npos;
+        i += r;
+        if (std::memcmp(h + i + 1, nd + 1, nn - 1) == 0) return i;
+    }
+    return npos;
+}
+
+inline std::size_t find_first_of(const char* s, std::size_t n, const char* set, std::size_t setn, bool negate) {
+    bool table[256] = {};
+    for (std::size_t i = 0; i < setn; ++i) table[static_cast<unsigned char>(set[i])] = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (table[static_cast<unsigned char>(s[i])] != negate) return i;
+    }
+    return npos;
+}
+
+inline std::size_t mismatch(const char* a, const char* b, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return n;
+}
+
+inline std::size_t imismatch(const char* a, const char* b, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (to_lower(static_cast<unsigned char>(a[i])) != to_lower(static_cast<unsigned char>(b[i]))) return i;
+    }
+    return n;
+}
+
+}
+
+#ifdef MSTD_SIMD_X86
+// ---------------------------------------------------------------------------
+// SSE2 实现, x86-64 上总是可用
+// ---------------------------------------------------------------------------
+namespace sse2 {
+
+inline __m128i fold_case(__m128i v) {
+    // 'A'..'Z' 都是正数, 因此可以直接用有符号比较; >= 0x80 的字节为负数, 不会被命中
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+inline std::size_t rfind_char(const char* s, std::size_t n, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    while (n >= 16) {
+        n -= 16;
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + n));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask) return n + 31 - __builtin_clz(mask);
+    }
+    return scalar::rfind_char(s, n, c);
+}
+
+inline std::size_t find(const char* h, std::size_t hn, const char* nd, std::size_t nn) {
+    if (nn <= 1) return nn == 0 ? 0 : scalar::find_char(h, hn, nd[0]);
+    if (nn > hn) return npos;
+    // 先用首尾两个字符过滤候选位置, 再对候选位置做完整比较
+    const __m128i first = _mm_set1_epi8(nd[0]);
+    const __m128i last = _mm_set1_epi8(nd[nn - 1]);
+    std::size_t i = 0;
+    for (; i + nn - 1 + 16 <= hn; i += 16) {
+        __m128i bf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+        __m128i bl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + nn - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last))));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (std::memcmp(h + i + bit + 1, nd + 1, nn - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    std::size_t r = scalar::find(h + i, hn - i, nd, nn);
+    return r == npos ? npos : i + r;
+}
+
+inline std::size_t find_first_of(const char* s, std::size_t n, const char* set, std::size_t setn, bool negate) {
+    // 字符集太大时逐个比较反而更慢, 交给查表实现
+    if (setn > 16) return scalar::find_first_of(s, n, set, setn, negate);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i hit = _mm_setzero_si128();
+        for (std::size_t k = 0; k < setn; ++k) {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(block, _mm_set1_epi8(set[k])));
+        }
+        int mask = _mm_movemask_epi8(hit);
+        if (negate) mask = ~mask & 0xFFFF;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    std::size_t r = scalar::find_first_of(s + i, n - i, set, setn, negate);
+    return r == npos ? npos : i + r;
+}
+
+inline std::size_t mismatch(const char* a, const char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xFFFF;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalar::mismatch(a + i, b + i, n - i);
+}
+
+inline std::size_t imismatch(const char* a, const char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = fold_case(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m128i vb = fold_case(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xFFFF;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalar::imismatch(a + i, b + i, n - i);
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 实现, 只在运行时检测到 CPU 支持时才会被调用
+// ---------------------------------------------------------------------------
+namespace avx2 {
+
+#define MSTD_AVX2 __attribute__((target("avx2")))
+
+MSTD_AVX2 inline __m256i fold_case(__m256i v) {
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+MSTD_AVX2 inline std::size_t rfind_char(const char* s, std::size_t n, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    while (n >= 32) {
+        n -= 32;
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + n));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask) return n + 31 - __builtin_clz(mask);
+    }
+    return sse2::rfind_char(s, n, c);
+}
+
+MSTD_AVX2 inline std::size_t find(const char* h, std::size_t hn, const char* nd, std::size_t nn) {
+    if (nn <= 1) return nn == 0 ? 0 : scalar::find_char(h, hn, nd[0]);
+    if (nn > hn) return npos;
+    const __m256i first = _mm256_set1_epi8(nd[0]);
+    const __m256i last = _mm256_set1_epi8(nd[nn - 1]);
+    std::size_t i = 0;
+    for (; i + nn - 1 + 32 <= hn; i += 32) {
+        __m256i bf = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i));
+        __m256i bl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + nn - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(bf, first), _mm256_cmpeq_epi8(bl, last))));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (std::memcmp(h + i + bit + 1, nd + 1, nn - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    std::size_t r = sse2::find(h + i, hn - i, nd, nn);
+    return r == npos ? npos : i + r;
+}
+
+MSTD_AVX2 inline std::size_t find_first_of(const char* s, std::size_t n, const char* set, std::size_t setn, bool negate) {
+    if (setn > 16) return scalar::find_first_of(s, n, set, setn, negate);
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        __m256i hit = _mm256_setzero_si256();
+        for (std::size_t k = 0; k < setn; ++k) {
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(set[k])));
+        }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (negate) mask = ~mask;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    std::size_t r = sse2::find_first_of(s + i, n - i, set, setn, negate);
+    return r == npos ? npos : i + r;
+}
+
+MSTD_AVX2 inline std::size_t mismatch(const char* a, const char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + sse2::mismatch(a + i, b + i, n - i);
+}
+
+MSTD_AVX2 inline std::size_t imismatch(const char* a, const char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = fold_case(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        __m256i vb = fold_case(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + sse2::imismatch(a + i, b + i, n - i);
+}
+
+#undef MSTD_AVX2
+
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// 运行时分发: 第一次调用时检测 CPU, 之后直接走函数指针
+// ---------------------------------------------------------------------------
+struct Kernels {
+    std::size_t (*rfind_char)(const char*, std::size_t, char);
+    std::size_t (*find)(const char*, std::size_t, const char*, std::size_t);
+    std::size_t (*find_first_of)(const char*, std::size_t, const char*, std::size_t, bool);
+    std::size_t (*mismatch)(const char*, const char*, std::size_t);
+    std::size_t (*imismatch)(const char*, const char*, std::size_t);
+    const char* name;
+};
+
+inline Kernels select_kernels() {
+#ifdef MSTD_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {avx2::rfind_char, avx2::find, avx2::find_first_of, avx2::mismatch, avx2::imismatch, "avx2"};
+    }
+    return {sse2::rfind_char, sse2::find, sse2::find_first_of, sse2::mismatch, sse2::imismatch, "sse2"};
+#else
+    return {scalar::rfind_char, scalar::find, scalar::find_first_of, scalar::mismatch, scalar::imismatch, "scalar"};
+#endif
+}
+
+inline const Kernels& kernels() {
+    static const Kernels k = select_kernels();
+    return k;
+}
+
+/// @brief 当前使用的实现名称 ("avx2" / "sse2" / "scalar")
+inline const char* active_kernel() {
+    return kernels().name;
+}
+
+inline std::size_t find_char(const char* s, std::size_t n, char c) {
+    return scalar::find_char(s, n, c);
+}
+
+inline std::size_t rfind_char(const char* s, std::size_t n, char c) {
+    return kernels().rfind_char(s, n, c);
+}
+
+/// @brief 在 [h, h+hn) 中查找子串 [nd, nd+nn), 返回下标或 npos
+inline std::size_t find(const char* h, std::size_t hn, const char* nd, std::size_t nn) {
+    return kernels().find(h, hn, nd, nn);
+}
+
+/// @brief 从后往前查找子串, 返回最后一次出现的下标或 npos
+inline std::size_t rfind(const char* h, std::size_t hn, const char* nd, std::size_t nn) {
+    if (nn == 0) return hn;
+    if (nn > hn) return npos;
+    // 用首字符做反向定位, 再比较剩余部分
+    std::size_t limit = hn - nn + 1;
+    while (limit > 0) {
+        std::size_t pos = rfind_char(h, limit, nd[0]);
+        if (pos == npos) return npos;
+        if (std::memcmp(h + pos + 1, nd + 1, nn - 1) == 0) return pos;
+        limit = pos;
+    }
+    return npos;
+}
+
+inline std::size_t find_first_of(const char* s, std::size_t n, const char* set, std::size_t setn) {
+    return kernels().find_first_of(s, n, set, setn, false);
+}
+
+inline std::size_t find_first_not_of(const char* s, std::size_t n, const char* set, std::size_t setn) {
+    return kernels().find_first_of(s, n, set, setn, true);
+}
+
+/// @brief 返回第一个不相同字节的下标, 完全相同时返回 n
+inline std::size_t mismatch(const char* a, const char* b, std::size_t n) {
+    return kernels().mismatch(a, b, n);
+}
+
+/// @brief 按字节序比较两段数据, 语义与 std::string::compare 一致
+inline int compare(const char* a, std::size_t an, const char* b, std::size_t bn) {
+    std::size_t n = an < bn ? an : bn;
+    std::size_t i = n ? mismatch(a, b, n) : 0;
+    if (i < n) return static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[i]) ? -1 : 1;
+    return an == bn ? 0 : (an < bn ? -1 : 1);
+}
+
+/// @brief 忽略 ASCII 大小写的比较
+inline int icompare(const char* a, std::size_t an, const char* b, std::size_t bn) {
+    std::size_t n = an < bn ? an : bn;
+    std::size_t i = n ? kernels().imismatch(a, b, n) : 0;
+    if (i < n) {
+        return to_lower(static_cast<unsigned char>(a[i])) < to_lower(static_cast<unsigned char>(b[i])) ? -1 : 1;
+    }
+    return an == bn ? 0 : (an < bn ? -1 : 1);
+}
+
+// ---------------------------------------------------------------------------
+// 哈希: 每次吃 8 字节, 用 64x64->128 乘法混合 (参考 wyhash 的 mum 思路)
+// ---------------------------------------------------------------------------
+namespace detail {
+
+inline std::uint64_t read64(const char* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline std::uint64_t read_tail(const char* p, std::size_t n) {
+    std::uint64_t v = 0;
+    std::memcpy(&v, p, n);
+    return v;
+}
+
+inline std::uint64_t mum(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+    std::uint64_t r = a * b;
+    return r ^ (r >> 32) ^ (a >> 29) * 0x9E3779B97F4A7C15ull;
+#endif
+}
+
+}
+
+inline std::uint64_t hash(const char* s, std::size_t n, std::uint64_t seed = 0) {
+    constexpr std::uint64_t k0 = 0xa0761d6478bd642full;
+    constexpr std::uint64_t k1 = 0xe7037ed1a0b428dbull;
+    constexpr std::uint64_t k2 = 0x8ebc6af09c88c6e3ull;
+    std::uint64_t h = seed ^ k0 ^ (static_cast<std::uint64_t>(n) * k1);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        h = detail::mum(detail::read64(s + i) ^ k1, detail::read64(s + i + 8) ^ h);
+    }
+    if (i + 8 <= n) {
+        h = detail::mum(detail::read64(s + i) ^ k2, h ^ k1);
+        i += 8;
+    }
+    if (i < n) {
+        h = detail::mum(detail::read_tail(s + i, n - i) ^ k2, h ^ k0);
+    }
+    return detail::mum(h ^ k2, static_cast<std::uint64_t>(n) ^ k1);
+}
+
+}
+}
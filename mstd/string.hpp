@@ -4,7 +4,10 @@
 #include <stdexcept>
 #include <memory>
 #include <string>
+#include <functional>
+#include <algorithm>
 #include "iterator.hpp"
+#include "string_view.hpp"
 
 namespace mstd {
 
@@ -13,19 +16,24 @@ public:
     using iterator = Iterator<char>;
     using const_iterator = Iterator<const char>;
 
+    static constexpr std::size_t npos = string_view::npos;
+
     string() : data_(nullptr), size_(0), capacity_(0) {}
     
-    string(const char* s) {
-        size_ = std::strlen(s);
-        capacity_ = size_;
+    string(const char* s) : string(s, std::strlen(s)) {}
+
+    explicit string(string_view s) : string(s.data(), s.size()) {}
+
+    string(const char* s, std::size_t n) : size_(n), capacity_(n) {
         data_ = std::make_unique<char[]>(capacity_ + 1);
-        std::memcpy(data_.get(), s, size_ + 1);
+        std::memcpy(data_.get(), s, size_);
+        data_[size_] = '\0';
     }
 
     // 拷贝构造函数
     string(const string& other) : size_(other.size_), capacity_(other.capacity_) {
         data_ = std::make_unique<char[]>(capacity_ + 1);
-        std::memcpy(data_.get(), other.data_.get(), size_ + 1);
+        std::memcpy(data_.get(), other.c_str(), size_ + 1);
     }
 
     // 移动构造函数
@@ -41,7 +49,7 @@ public:
             data_ = std::make_unique<char[]>(other.capacity_ + 1);
             size_ = other.size_;
             capacity_ = other.capacity_;
-            std::memcpy(data_.get(), other.data_.get(), size_ + 1);
+            std::memcpy(data_.get(), other.c_str(), size_ + 1);
         }
         return *this;
     }
@@ -62,7 +70,13 @@ public:
     /// @brief 返回字符数组
     /// @return 
     inline const char* c_str() const {
-        return data_.get();
+        return data_ ? data_.get() : "";
+    }
+
+    /// @brief 返回字符数组 (与 c_str 相同)
+    /// @return 
+    inline const char* data() const {
+        return c_str();
     }
 
     /// @brief 返回字符串长度
@@ -77,10 +91,16 @@ public:
         return capacity_;
     }
 
+    /// @brief 字符串是否为空
+    /// @return 
+    inline bool empty() const {
+        return size_ == 0;
+    }
+
     /// @brief 扩大字符串的内存大小
     /// @param new_capacity 字符串新的内存大小
     void reserve(std::size_t new_capacity) {
-        if (new_capacity > capacity_) {
+        if (new_capacity > capacity_ || !data_) {
             auto new_data = std::make_unique<char[]>(new_capacity + 1);
             if (data_) {
                 std::memcpy(new_data.get(), data_.get(), size_ + 1);
@@ -93,13 +113,66 @@ public:
     /// @brief 重新设置字符串长度
     /// @param new_size 字符串新的长度
     void resize(std::size_t new_size) {
-        if (new_size > capacity_) {
+        if (new_size > capacity_ || !data_) {
             reserve(new_size);
         }
         size_ = new_size;
         data_[size_] = '\0';
     }
 
+    /// @brief 在字符串尾部追加内容, 容量不足时按 2 倍增长, 均摊 O(1)
+    /// @param s 要追加的内容, 允许引用自身
+    /// @return
+    string& append(string_view s) {
+        std::size_t new_size = size_ + s.size();
+        if (new_size > capacity_ || !data_) {
+            // 先拷贝到新内存再释放旧内存, 这样 s 指向自身时也是安全的
+            std::size_t new_capacity = std::max(new_size, capacity_ * 2);
+            auto new_data = std::make_unique<char[]>(new_capacity + 1);
+            std::memcpy(new_data.get(), c_str(), size_);
+            std::memcpy(new_data.get() + size_, s.data(), s.size());
+            data_ = std::move(new_data);
+            capacity_ = new_capacity;
+        } else {
+            std::memmove(data_.get() + size_, s.data(), s.size());
+        }
+        size_ = new_size;
+        data_[size_] = '\0';
+        return *this;
+    }
+
+    string& append(const char* s, std::size_t n) {
+        return append(string_view(s, n));
+    }
+
+    void push_back(char c) {
+        append(string_view(&c, 1));
+    }
+
+    string& operator+=(string_view s) {
+        return append(s);
+    }
+
+    string& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    /// @brief 清空内容, 保留已分配的内存
+    void clear() {
+        if (data_) {
+            size_ = 0;
+            data_[0] = '\0';
+        }
+    }
+
+    friend string operator+(const string& a, string_view b) {
+        string result;
+        result.reserve(a.size_ + b.size());
+        result.append(a).append(b);
+        return result;
+    }
+
     char& operator[](std::size_t index) {
         if (index >= size_) {
             throw std::out_of_range("Index out of range");
@@ -137,14 +210,132 @@ public:
         len = std::min(len, size_ - pos);
         string result;
         result.resize(len);
-        std::memcpy(result.data_.get(), data_.get() + pos, len);
+        std::memcpy(result.data_.get(), c_str() + pos, len);
         result.data_[len] = '\0';
         return result;
     }
 
+    /// @brief 返回子串视图, 不会分配内存
+    /// @param pos 起始位置
+    /// @param len 长度, 超出部分会被截断
+    /// @return
+    string_view view(std::size_t pos = 0, std::size_t len = npos) const {
+        return string_view(c_str(), size_).substr(pos, len);
+    }
+
+    // 隐式转换为 string_view, 只复制指针和长度
+    operator string_view() const noexcept {
+        return string_view(c_str(), size_);
+    }
+
+    // 以下查找/比较函数都转发给 string_view 实现
+
+    /// @brief 查找字符第一次出现的位置
+    /// @param c 要查找的字符
+    /// @param pos 开始查找的位置
+    /// @return 下标, 未找到返回 npos
+    std::size_t find(char c, std::size_t pos = 0) const {
+        return view().find(c, pos);
+    }
+
+    /// @brief 查找子串第一次出现的位置
+    /// @param s 要查找的子串
+    /// @param pos 开始查找的位置
+    /// @return 下标, 未找到返回 npos
+    std::size_t find(string_view s, std::size_t pos = 0) const {
+        return view().find(s, pos);
+    }
+
+    /// @brief 参数顺序与 std::string 一致: (子串, 起始位置, 子串长度)
+    std::size_t find(const char* s, std::size_t pos, std::size_t n) const {
+        return view().find(s, pos, n);
+    }
+
+    /// @brief 从后往前查找字符
+    /// @param c 要查找的字符
+    /// @param pos 最后一个可能匹配的位置, 默认为整个字符串
+    /// @return 下标, 未找到返回 npos
+    std::size_t rfind(char c, std::size_t pos = npos) const {
+        return view().rfind(c, pos);
+    }
+
+    /// @brief 从后往前查找子串
+    /// @param s 要查找的子串
+    /// @param pos 子串起始位置的上限, 默认为整个字符串
+    /// @return 下标, 未找到返回 npos
+    std::size_t rfind(string_view s, std::size_t pos = npos) const {
+        return view().rfind(s, pos);
+    }
+
+    std::size_t rfind(const char* s, std::size_t pos, std::size_t n) const {
+        return view().rfind(s, pos, n);
+    }
+
+    /// @brief 查找第一个属于字符集合的字符
+    /// @param set 字符集合
+    /// @param pos 开始查找的位置
+    /// @return 下标, 未找到返回 npos
+    std::size_t find_first_of(string_view set, std::size_t pos = 0) const {
+        return view().find_first_of(set, pos);
+    }
+
+    /// @brief 查找第一个不属于字符集合的字符
+    /// @param set 字符集合
+    /// @param pos 开始查找的位置
+    /// @return 下标, 未找到返回 npos
+    std::size_t find_first_not_of(string_view set, std::size_t pos = 0) const {
+        return view().find_first_not_of(set, pos);
+    }
+
+    std::size_t find_last_of(string_view set, std::size_t pos = npos) const {
+        return view().find_last_of(set, pos);
+    }
+
+    std::size_t find_last_not_of(string_view set, std::size_t pos = npos) const {
+        return view().find_last_not_of(set, pos);
+    }
+
+    /// @brief 按字节序比较, 返回值语义与 std::string::compare 一致
+    int compare(string_view other) const {
+        return view().compare(other);
+    }
+
+    /// @brief 忽略 ASCII 大小写比较
+    int icompare(string_view other) const {
+        return view().icompare(other);
+    }
+
+    /// @brief 忽略 ASCII 大小写判断是否相等
+    bool iequals(string_view other) const {
+        return view().iequals(other);
+    }
+
+    bool starts_with(string_view s) const {
+        return view().starts_with(s);
+    }
+
+    bool ends_with(string_view s) const {
+        return view().ends_with(s);
+    }
+
+    /// @brief 按分隔符切分, 返回子串视图的区间
+    string_view::split_range split(char delim) const {
+        return view().split(delim);
+    }
+
+    /// @brief 按分隔符集合切分并跳过空字段
+    string_view::split_range tokenize(string_view delims = " \t\n\r") const {
+        return view().tokenize(delims);
+    }
+
+    /// @brief 计算字符串的哈希值
+    std::size_t hash() const noexcept {
+        return view().hash();
+    }
+
     // 添加转换为std::string的函数
     std::string to_std_string() const {
-        return std::string(data_.get());
+        return std::string(c_str(), size_);
     }
 
     // 添加隐式转换运算符
@@ -164,4 +355,52 @@ private:
     std::size_t capacity_;
 };
 
+/// @brief 字符串哈希函数对象, mstd::string / string_view / std::string 作为 key 时结果一致
+struct string_hash {
+    std::size_t operator()(string_view s) const {
+        return s.hash();
+    }
+
+    std::size_t operator()(const string& s) const {
+        return s.hash();
+    }
+
+    std::size_t operator()(const std::string& s) const {
+        return string_view(s).hash();
+    }
+};
+
+/// @brief 忽略 ASCII 大小写的哈希函数对象, 配合 string_iequal 使用
+struct string_ihash {
+    std::size_t operator()(string_view s) const {
+        // 按块转成小写再哈希, 避免为整个字符串分配临时内存
+        char buf[64];
+        std::uint64_t h = 0;
+        for (std::size_t i = 0; i < s.size(); i += sizeof(buf)) {
+            std::size_t n = std::min(sizeof(buf), s.size() - i);
+            for (std::size_t k = 0; k < n; ++k) buf[k] = static_cast<char>(simd::to_lower(static_cast<unsigned char>(s.data()[i + k])));
+            h = simd::hash(buf, n, h);
+        }
+        return static_cast<std::size_t>(h);
+    }
+};
+
+/// @brief 忽略 ASCII 大小写的相等比较函数对象
+struct string_iequal {
+    bool operator()(string_view a, string_view b) const {
+        return a.iequals(b);
+    }
+};
+
+}
+
+namespace std {
+
+template <>
+struct hash<mstd::string> {
+    std::size_t operator()(const mstd::string& s) const noexcept {
+        return s.hash();
+    }
+};
+
 }
\ No newline at end of file
@@ -0,0 +1,318 @@
+#pragma once
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include "string.hpp"
+
+#ifdef _WIN32
+namespace mstd {
+// Windows 下没有 writev, 这里只提供同样布局的结构体, 方便上层自己拼接发送
+struct iovec {
+    void* iov_base;
+    std::size_t iov_len;
+};
+}
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#include <climits>
+#include <cerrno>
+namespace mstd {
+using ::iovec;
+}
+#endif
+
+namespace mstd {
+
+/// @brief 分块追加的字符串构建器
+/// 追加的数据写入按倍数增长的内存块, 已写入的数据不会再被搬移;
+/// append_ref 只记录引用而不拷贝, 最终可以整体拷出, 也可以导出 iovec 列表交给 writev
+class string_builder {
+public:
+    /// @brief 创建构建器
+    /// @param first_chunk 第一个内存块的大小, 之后每块翻倍, 最大 max_chunk_size
+    explicit string_builder(std::size_t first_chunk = 256)
+        : next_chunk_(std::max<std::size_t>(first_chunk, 16)), cur_(nullptr), cur_used_(0), cur_cap_(0), size_(0) {}
+
+    string_builder(const string_builder&) = delete;
+    string_builder& operator=(const string_builder&) = delete;
+
+    string_builder(string_builder&& other) noexcept
+        : chunks_(std::move(other.chunks_)), segments_(std::move(other.segments_)), keep_alive_(std::move(other.keep_alive_)),
+          next_chunk_(other.next_chunk_), cur_(other.cur_), cur_used_(other.cur_used_), cur_cap_(other.cur_cap_), size_(other.size_) {
+        other.reset_after_move();
+    }
+
+    string_builder& operator=(string_builder&& other) noexcept {
+        if (this != &other) {
+            chunks_ = std::move(other.chunks_);
+            segments_ = std::move(other.segments_);
+            keep_alive_ = std::move(other.keep_alive_);
+            next_chunk_ = other.next_chunk_;
+            cur_ = other.cur_;
+            cur_used_ = other.cur_used_;
+            cur_cap_ = other.cur_cap_;
+            size_ = other.size_;
+            other.reset_after_move();
+        }
+        return *this;
+    }
+
+    static constexpr std::size_t max_chunk_size = 64 * 1024;
+
+    /// @brief 追加并拷贝数据
+    /// @param s 要追加的内容
+    /// @return
+    string_builder& append(string_view s) {
+        const char* p = s.data();
+        std::size_t n = s.size();
+        while (n > 0) {
+            if (cur_used_ == cur_cap_) new_chunk(n);
+            std::size_t m = std::min(n, cur_cap_ - cur_used_);
+            std::memcpy(cur_ + cur_used_, p, m);
+            push_segment(cur_ + cur_used_, m);
+            cur_used_ += m;
+            p += m;
+            n -= m;
+        }
+        return *this;
+    }
+
+    string_builder& append(const char* s, std::size_t n) {
+        return append(string_view(s, n));
+    }
+
+    // 单独提供 const char* 重载, 否则字符串字面量会优先匹配 append(bool)
+    string_builder& append(const char* s) {
+        return append(string_view(s));
+    }
+
+    string_builder& append(char c) {
+        return append(string_view(&c, 1));
+    }
+
+    /// @brief 用 std::to_chars 格式化整数, 不经过 iostream/locale
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value, int>::type = 0>
+    string_builder& append(T value) {
+        char* out = reserve_inline(24);
+        auto r = std::to_chars(out, out + 24, value);
+        commit_inline(out, static_cast<std::size_t>(r.ptr - out));
+        return *this;
+    }
+
+    /// @brief 用 std::to_chars 格式化浮点数 (按原类型的最短可还原表示), float / double / long double 都可以
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    string_builder& append(T value) {
+        // long double 的最短表示最多约 30 个字符 ("-1.18973149535723176502e+4932")
+        constexpr std::size_t max_size = std::is_same<T, long double>::value ? 48 : 32;
+        char* out = reserve_inline(max_size);
+        auto r = std::to_chars(out, out + max_size, value);
+        commit_inline(out, static_cast<std::size_t>(r.ptr - out));
+        return *this;
+    }
+
+    string_builder& append(bool value) {
+        return append(value ? string_view("true", 4) : string_view("false", 5));
+    }
+
+    /// @brief 追加引用, 不拷贝数据; 调用者需要保证数据在构建器使用期间有效
+    /// @param s 被引用的数据
+    /// @return
+    string_builder& append_ref(string_view s) {
+        if (!s.empty()) {
+            segments_.push_back({s.data(), s.size()});
+            size_ += s.size();
+        }
+        return *this;
+    }
+
+    /// @brief 追加引用并持有所有权, 例如 FileCache::get_shared 返回的文件内容
+    /// @param body 共享的数据块
+    /// @return
+    string_builder& append_ref(std::shared_ptr<const std::vector<char>> body) {
+        if (body && !body->empty()) {
+            append_ref(string_view(body->data(), body->size()));
+            keep_alive_.push_back(std::move(body));
+        }
+        return *this;
+    }
+
+    template <typename T>
+    string_builder& operator<<(T&& value) {
+        return append(std::forward<T>(value));
+    }
+
+    /// @brief 当前总长度
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    /// @brief 片段数量 (即 iovecs() 的长度)
+    std::size_t segment_count() const {
+        return segments_.size();
+    }
+
+    /// @brief 导出分散/聚集 IO 用的片段列表, 指针在构建器被修改或销毁前有效
+    std::vector<iovec> iovecs() const {
+        std::vector<iovec> out;
+        out.reserve(segments_.size());
+        for (const auto& seg : segments_) {
+            out.push_back(iovec{const_cast<char*>(seg.data), seg.size});
+        }
+        return out;
+    }
+
+    /// @brief 拷贝到连续的内存中
+    /// @param dest 目标内存, 至少 size() 字节
+    void copy_to(char* dest) const {
+        for (const auto& seg : segments_) {
+            std::memcpy(dest, seg.data, seg.size);
+            dest += seg.size;
+        }
+    }
+
+    std::string str() const {
+        std::string out(size_, '\0');
+        copy_to(out.data());
+        return out;
+    }
+
+    mstd::string to_string() const {
+        mstd::string out;
+        out.resize(size_);
+        if (size_) copy_to(&out[0]);
+        return out;
+    }
+
+#ifndef _WIN32
+    /// @brief write_to 的结果
+    struct write_result {
+        std::size_t written; // 本次调用写出的字节数, 出错时也包含出错前已经写出的部分
+        int error;           // 0 表示全部写完; 否则为 errno (非阻塞 socket 写满时为 EAGAIN / EWOULDBLOCK)
+
+        bool complete() const {
+            return error == 0;
+        }
+    };
+
+    /// @brief 用 writev 把片段写到文件描述符, 处理部分写入和 IOV_MAX 限制
+    /// 非阻塞 socket 写满时返回已经写出的字节数, 等可写后把 offset 加上 written 再次调用即可继续
+    /// @param fd 文件描述符 (socket / 文件)
+    /// @param offset 从第几个字节开始写 (之前已经写出的字节数)
+    /// @return 写出的字节数和错误码
+    write_result write_to(int fd, std::size_t offset = 0) const {
+        std::vector<iovec> iov;
+        iov.reserve(segments_.size());
+        for (const auto& seg : segments_) {
+            if (offset >= seg.size) {
+                offset -= seg.size;
+                continue;
+            }
+            iov.push_back(iovec{const_cast<char*>(seg.data) + offset, seg.size - offset});
+            offset = 0;
+        }
+        std::size_t idx = 0;
+        std::size_t total = 0;
+        while (idx < iov.size()) {
+            int count = static_cast<int>(std::min<std::size_t>(iov.size() - idx, IOV_MAX));
+            ssize_t n = ::writev(fd, iov.data() + idx, count);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return write_result{total, errno};
+            }
+            total += static_cast<std::size_t>(n);
+            // 跳过已经完整写出的片段, 调整写了一半的片段
+            std::size_t left = static_cast<std::size_t>(n);
+            while (idx < iov.size() && left >= iov[idx].iov_len) {
+                left -= iov[idx].iov_len;
+                ++idx;
+            }
+            if (left > 0) {
+                iov[idx].iov_base = static_cast<char*>(iov[idx].iov_base) + left;
+                iov[idx].iov_len -= left;
+            }
+        }
+        return write_result{total, 0};
+    }
+#endif
+
+    /// @brief 清空内容; 保留最后一个内存块以便复用
+    void clear() {
+        segments_.clear();
+        keep_alive_.clear();
+        if (chunks_.size() > 1) {
+            std::unique_ptr<char[]> last = std::move(chunks_.back());
+            chunks_.clear();
+            chunks_.push_back(std::move(last));
+        }
+        cur_used_ = 0;
+        size_ = 0;
+    }
+
+private:
+    struct Segment {
+        const char* data;
+        std::size_t size;
+    };
+
+    // 被移动后内存块已经转移, 不能再往旧指针里写
+    void reset_after_move() {
+        chunks_.clear();
+        segments_.clear();
+        keep_alive_.clear();
+        cur_ = nullptr;
+        cur_used_ = 0;
+        cur_cap_ = 0;
+        size_ = 0;
+    }
+
+    // 与上一个片段相邻时直接合并, 连续的小追加只占用一个 iovec
+    void push_segment(const char* p, std::size_t n) {
+        if (!segments_.empty() && segments_.back().data + segments_.back().size == p) {
+            segments_.back().size += n;
+        } else {
+            segments_.push_back({p, n});
+        }
+        size_ += n;
+    }
+
+    void new_chunk(std::size_t at_least) {
+        std::size_t cap = std::max(next_chunk_, std::min(at_least, max_chunk_size));
+        chunks_.push_back(std::make_unique<char[]>(cap));
+        cur_ = chunks_.back().get();
+        cur_used_ = 0;
+        cur_cap_ = cap;
+        next_chunk_ = std::min(next_chunk_ * 2, max_chunk_size);
+    }
+
+    // 数字格式化需要一段连续空间, 当前块剩余不足时直接换新块
+    char* reserve_inline(std::size_t n) {
+        if (cur_cap_ - cur_used_ < n) new_chunk(n);
+        return cur_ + cur_used_;
+    }
+
+    void commit_inline(char* p, std::size_t n) {
+        push_segment(p, n);
+        cur_used_ += n;
+    }
+
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    std::vector<Segment> segments_;
+    std::vector<std::shared_ptr<const std::vector<char>>> keep_alive_;
+    std::size_t next_chunk_; // 下一个内存块的大小
+    char* cur_; // 当前写入的内存块
+    std::size_t cur_used_;
+    std::size_t cur_cap_;
+    std::size_t size_; // 总字节数
+};
+
+}
@@ -0,0 +1,308 @@
+#pragma once
+#include <iostream>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include "iterator.hpp"
+#include "simd.hpp"
+
+namespace mstd {
+
+/// @brief 不持有内存的只读字符串视图, 只保存指针和长度
+/// 视图的生命周期不能超过它引用的字符串
+class string_view {
+public:
+    using const_iterator = Iterator<const char>;
+    using iterator = const_iterator;
+
+    static constexpr std::size_t npos = simd::npos;
+
+    class split_range;
+
+    constexpr string_view() noexcept : data_(""), size_(0) {}
+    constexpr string_view(const char* s, std::size_t n) noexcept : data_(s), size_(n) {}
+    string_view(const char* s) noexcept : data_(s), size_(std::strlen(s)) {}
+    string_view(const std::string& s) noexcept : data_(s.data()), size_(s.size()) {}
+    constexpr string_view(std::string_view s) noexcept : data_(s.data()), size_(s.size()) {}
+
+    constexpr const char* data() const noexcept { return data_; }
+    constexpr std::size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+
+    const char& operator[](std::size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return data_[index];
+    }
+
+    constexpr char front() const { return data_[0]; }
+    constexpr char back() const { return data_[size_ - 1]; }
+
+    const_iterator begin() const { return const_iterator(data_); }
+    const_iterator end() const { return const_iterator(data_ + size_); }
+
+    /// @brief 返回子视图, 不会分配内存
+    /// @param pos 起始位置
+    /// @param len 长度, 超出部分会被截断
+    /// @return
+    string_view substr(std::size_t pos, std::size_t len = npos) const {
+        if (pos > size_) {
+            throw std::out_of_range("Position out of range");
+        }
+        return string_view(data_ + pos, std::min(len, size_ - pos));
+    }
+
+    void remove_prefix(std::size_t n) { data_ += n; size_ -= n; }
+    void remove_suffix(std::size_t n) { size_ -= n; }
+
+    /// @brief 去除前后空白字符后的视图
+    /// @param ws 空白字符集合
+    /// @return
+    string_view trim(const char* ws = " \t\n\r") const {
+        // 两端的空白一般很短, 逐个字符判断, 不走 SIMD 查找
+        const std::size_t wsSize = std::strlen(ws);
+        std::size_t first = 0;
+        std::size_t last = size_;
+        while (first < last && std::memchr(ws, data_[first], wsSize)) ++first;
+        while (last > first && std::memchr(ws, data_[last - 1], wsSize)) --last;
+        return string_view(data_ + first, last - first);
+    }
+
+    std::size_t find(char c, std::size_t pos = 0) const {
+        if (pos >= size_) return npos;
+        std::size_t r = simd::find_char(data_ + pos, size_ - pos, c);
+        return r == npos ? npos : pos + r;
+    }
+
+    std::size_t find(string_view s, std::size_t pos = 0) const {
+        if (pos > size_) return npos;
+        std::size_t r = simd::find(data_ + pos, size_ - pos, s.data_, s.size_);
+        return r == npos ? npos : pos + r;
+    }
+
+    /// @brief 参数顺序与 std::string_view 一致: (子串, 起始位置, 子串长度)
+    std::size_t find(const char* s, std::size_t pos, std::size_t n) const {
+        return find(string_view(s, n), pos);
+    }
+
+    std::size_t rfind(char c, std::size_t pos = npos) const {
+        if (size_ == 0) return npos;
+        return simd::rfind_char(data_, pos >= size_ ? size_ : pos + 1, c);
+    }
+
+    std::size_t rfind(string_view s, std::size_t pos = npos) const {
+        if (s.size_ > size_) return npos;
+        return simd::rfind(data_, std::min(pos, size_ - s.size_) + s.size_, s.data_, s.size_);
+    }
+
+    std::size_t rfind(const char* s, std::size_t pos, std::size_t n) const {
+        return rfind(string_view(s, n), pos);
+    }
+
+    std::size_t find_first_of(string_view set, std::size_t pos = 0) const {
+        if (pos >= size_) return npos;
+        std::size_t r = simd::find_first_of(data_ + pos, size_ - pos, set.data_, set.size_);
+        return r == npos ? npos : pos + r;
+    }
+
+    std::size_t find_first_not_of(string_view set, std::size_t pos = 0) const {
+        if (pos >= size_) return npos;
+        std::size_t r = simd::find_first_not_of(data_ + pos, size_ - pos, set.data_, set.size_);
+        return r == npos ? npos : pos + r;
+    }
+
+    std::size_t find_last_of(string_view set, std::size_t pos = npos) const {
+        for (std::size_t i = std::min(pos, size_ - 1) + 1; size_ && i-- > 0;) {
+            if (std::memchr(set.data_, data_[i], set.size_)) return i;
+        }
+        return npos;
+    }
+
+    std::size_t find_last_not_of(string_view set, std::size_t pos = npos) const {
+        for (std::size_t i = std::min(pos, size_ - 1) + 1; size_ && i-- > 0;) {
+            if (!std::memchr(set.data_, data_[i], set.size_)) return i;
+        }
+        return npos;
+    }
+
+    /// @brief 按字节序比较, 返回值语义与 std::string::compare 一致
+    int compare(string_view other) const {
+        return simd::compare(data_, size_, other.data_, other.size_);
+    }
+
+    /// @brief 忽略 ASCII 大小写比较
+    int icompare(string_view other) const {
+        return simd::icompare(data_, size_, other.data_, other.size_);
+    }
+
+    /// @brief 忽略 ASCII 大小写判断是否相等
+    bool iequals(string_view other) const {
+        return size_ == other.size_ && icompare(other) == 0;
+    }
+
+    bool starts_with(string_view s) const {
+        return s.size_ <= size_ && simd::mismatch(data_, s.data_, s.size_) == s.size_;
+    }
+
+    bool starts_with(char c) const {
+        return size_ > 0 && data_[0] == c;
+    }
+
+    bool ends_with(string_view s) const {
+        return s.size_ <= size_ && simd::mismatch(data_ + size_ - s.size_, s.data_, s.size_) == s.size_;
+    }
+
+    bool ends_with(char c) const {
+        return size_ > 0 && data_[size_ - 1] == c;
+    }
+
+    /// @brief 计算哈希值, 与相同内容的 mstd::string 一致
+    std::size_t hash() const noexcept {
+        return static_cast<std::size_t>(simd::hash(data_, size_));
+    }
+
+    /// @brief 按分隔符切分, 保留空字段 ("a,,b" -> "a", "", "b")
+    split_range split(char delim) const;
+
+    /// @brief 按分隔符集合切分, 跳过空字段 ("  a  b " -> "a", "b")
+    split_range tokenize(string_view delims = " \t\n\r") const;
+
+    std::string to_std_string() const {
+        return std::string(data_, size_);
+    }
+
+    explicit operator std::string() const {
+        return to_std_string();
+    }
+
+    constexpr operator std::string_view() const noexcept {
+        return std::string_view(data_, size_);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, string_view str) {
+        os.write(str.data_, static_cast<std::streamsize>(str.size_));
+        return os;
+    }
+
+private:
+    const char* data_;
+    std::size_t size_;
+};
+
+/// @brief split / tokenize 返回的惰性区间, 迭代时逐个产生子视图, 不分配内存
+class string_view::split_range {
+public:
+    class iterator {
+    public:
+        // 副本之间互不影响, 可以多次遍历, 满足前向迭代器的要求
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = string_view;
+        using reference = const string_view&;
+        using pointer = const string_view*;
+
+        iterator() : rest_(), delims_(), delim_('\0'), skip_empty_(false), done_(true) {}
+
+        iterator(string_view text, string_view delims, char delim, bool skip_empty)
+            : rest_(text), delims_(delims), delim_(delim), skip_empty_(skip_empty), done_(false) {
+            advance();
+        }
+
+        reference operator*() const { return current_; }
+        pointer operator->() const { return &current_; }
+
+        iterator& operator++() {
+            advance();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator tmp = *this;
+            advance();
+            return tmp;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) {
+            return a.done_ == b.done_ && (a.done_ || a.current_.data() == b.current_.data());
+        }
+        friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+
+    private:
+        void advance() {
+            for (;;) {
+                if (rest_.data() == nullptr) {
+                    done_ = true;
+                    return;
+                }
+                std::size_t pos = delims_.empty() ? rest_.find(delim_) : rest_.find_first_of(delims_);
+                if (pos == npos) {
+                    current_ = rest_;
+                    rest_ = string_view(nullptr, 0); // 标记已经到达末尾
+                } else {
+                    current_ = rest_.substr(0, pos);
+                    rest_.remove_prefix(pos + 1);
+                }
+                if (!skip_empty_ || !current_.empty()) return;
+            }
+        }
+
+        string_view current_;
+        string_view rest_;
+        string_view delims_; // 为空时按单个字符 delim_ 切分
+        char delim_;
+        bool skip_empty_;
+        bool done_;
+    };
+
+    split_range(string_view text, char delim)
+        : text_(text), delims_(), delim_(delim), skip_empty_(false) {}
+
+    split_range(string_view text, string_view delims, bool skip_empty)
+        : text_(text), delims_(delims), delim_('\0'), skip_empty_(skip_empty) {}
+
+    iterator begin() const { return iterator(text_, delims_, delim_, skip_empty_); }
+    iterator end() const { return iterator(); }
+
+private:
+    string_view text_;
+    string_view delims_;
+    char delim_;
+    bool skip_empty_;
+};
+
+// 比较运算符定义为命名空间内的普通函数, mstd::string / const char* / std::string 都能通过 ADL 使用, 且不会产生临时对象
+inline bool operator==(string_view a, string_view b) {
+    return a.size() == b.size() && simd::mismatch(a.data(), b.data(), a.size()) == a.size();
+}
+
+inline bool operator!=(string_view a, string_view b) { return !(a == b); }
+inline bool operator<(string_view a, string_view b) { return a.compare(b) < 0; }
+inline bool operator>(string_view a, string_view b) { return a.compare(b) > 0; }
+inline bool operator<=(string_view a, string_view b) { return a.compare(b) <= 0; }
+inline bool operator>=(string_view a, string_view b) { return a.compare(b) >= 0; }
+
+inline string_view::split_range string_view::split(char delim) const {
+    return split_range(*this, delim);
+}
+
+inline string_view::split_range string_view::tokenize(string_view delims) const {
+    return split_range(*this, delims, true);
+}
+
+}
+
+namespace std {
+
+template <>
+struct hash<mstd::string_view> {
+    std::size_t operator()(mstd::string_view s) const noexcept {
+        return s.hash();
+    }
+};
+
+}
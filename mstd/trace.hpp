@@ -0,0 +1,386 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#ifdef MSTD_TRACE
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+#endif
+
+// 跟踪: 在库的热点路径上记录带时间戳的事件, 导出为 Chrome / Perfetto 能打开的 JSON
+// (chrome://tracing 或 https://ui.perfetto.dev)
+//
+// 编译时定义 MSTD_TRACE 开启 (CMake: -DMSTD_TRACE=ON), 整个程序必须统一开启或关闭.
+// 未开启时所有函数都是空的内联函数, Scope 是空对象, 优化后不产生任何代码.
+// 开启后每个线程把事件写入自己的环形缓冲区, 记录时不加锁; 缓冲区写满后覆盖最旧的事件.
+// 事件的分类、名字和参数名只保存指针, 必须是字符串字面量 (或者在导出前一直有效).
+
+#ifndef MSTD_TRACE_BUFFER_EVENTS
+#define MSTD_TRACE_BUFFER_EVENTS 16384 // 每个线程保留的事件数, 必须是 2 的幂
+#endif
+
+namespace mstd {
+namespace trace {
+
+#ifdef MSTD_TRACE
+
+constexpr bool enabled = true;
+
+namespace detail {
+
+// 每个字段都是 relaxed 原子变量: 导出时写线程可能正在覆盖同一个位置,
+// 这样读到的最多是不一致的事件 (会被丢弃), 而不是数据竞争
+struct Slot {
+    std::atomic<const char*> category{nullptr};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<const char*> argName{nullptr};
+    std::atomic<std::uint64_t> start{0};
+    std::atomic<std::uint64_t> duration{0};
+    std::atomic<std::int64_t> value{0};
+    std::atomic<char> phase{0};
+};
+
+struct Event {
+    const char* category;
+    const char* name;
+    const char* argName;
+    std::uint64_t start;
+    std::uint64_t duration;
+    std::int64_t value;
+    char phase;
+};
+
+class ThreadBuffer {
+public:
+    static constexpr std::uint64_t capacity = MSTD_TRACE_BUFFER_EVENTS;
+    static_assert((capacity & (capacity - 1)) == 0, "MSTD_TRACE_BUFFER_EVENTS must be a power of two");
+
+    explicit ThreadBuffer(std::uint32_t tid) : tid_(tid), slots_(new Slot[capacity]), written_(0), floor_(0) {}
+
+    // 只由所属线程调用
+    void push(char phase, const char* category, const char* name, std::uint64_t start, std::uint64_t duration,
+              const char* argName, std::int64_t value) {
+        std::uint64_t i = written_.load(std::memory_order_relaxed);
+        // 与 collect 中的 acquire 栅栏配对: 读到这次写入的数据时, 一定也能看到 written_ >= i
+        std::atomic_thread_fence(std::memory_order_release);
+        Slot& slot = slots_[i & (capacity - 1)];
+        slot.phase.store(phase, std::memory_order_relaxed);
+        slot.category.store(category, std::memory_order_relaxed);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.argName.store(argName, std::memory_order_relaxed);
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.duration.store(duration, std::memory_order_relaxed);
+        slot.value.store(value, std::memory_order_relaxed);
+        written_.store(i + 1, std::memory_order_release);
+    }
+
+    /// @brief 复制出当前保留的事件, 可以在其他线程调用
+    void collect(std::vector<Event>& out) const {
+        std::uint64_t end = written_.load(std::memory_order_acquire);
+        std::uint64_t begin = std::max(floor_.load(std::memory_order_relaxed), end > capacity ? end - capacity : 0);
+        size_t first = out.size();
+        for (std::uint64_t i = begin; i < end; ++i) {
+            const Slot& slot = slots_[i & (capacity - 1)];
+            out.push_back(Event{slot.category.load(std::memory_order_relaxed), slot.name.load(std::memory_order_relaxed),
+                                slot.argName.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                                slot.duration.load(std::memory_order_relaxed), slot.value.load(std::memory_order_relaxed),
+                                slot.phase.load(std::memory_order_relaxed)});
+        }
+        // 复制期间写线程可能绕了一圈, 丢掉已经 (或正在) 被覆盖的部分
+        std::atomic_thread_fence(std::memory_order_acquire);
+        std::uint64_t now = written_.load(std::memory_order_relaxed);
+        std::uint64_t valid = now + 1 > capacity ? now + 1 - capacity : 0;
+        if (valid > begin) {
+            std::uint64_t overwritten = std::min(valid, end) - begin;
+            out.erase(out.begin() + static_cast<std::ptrdiff_t>(first),
+                      out.begin() + static_cast<std::ptrdiff_t>(first + overwritten));
+        }
+    }
+
+    void clear() {
+        floor_.store(written_.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+
+    std::uint32_t tid() const {
+        return tid_;
+    }
+
+    std::string name; // 由 registry 的锁保护
+
+private:
+    const std::uint32_t tid_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<std::uint64_t> written_; // 已经写入的事件总数
+    std::atomic<std::uint64_t> floor_;   // clear() 之前的事件不再导出
+};
+
+// 所有线程的缓冲区; 线程退出后缓冲区放入 idle, 由之后新建的线程接着使用 (沿用同一个 tid),
+// 缓冲区的数量不超过同时存在的线程数. 已经结束的线程的事件在被新线程覆盖之前仍然可以导出
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> idle;
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// 线程持有的缓冲区, 线程退出时归还给 registry
+class LocalBuffer {
+public:
+    LocalBuffer() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.idle.empty()) {
+            buffer_ = r.idle.back();
+            r.idle.pop_back();
+            buffer_->name.clear();
+        } else {
+            r.buffers.push_back(std::make_shared<ThreadBuffer>(static_cast<std::uint32_t>(r.buffers.size() + 1)));
+            buffer_ = r.buffers.back().get();
+        }
+    }
+
+    LocalBuffer(const LocalBuffer&) = delete;
+    LocalBuffer& operator=(const LocalBuffer&) = delete;
+
+    ~LocalBuffer() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.idle.push_back(buffer_);
+    }
+
+    ThreadBuffer& get() {
+        return *buffer_;
+    }
+
+private:
+    ThreadBuffer* buffer_;
+};
+
+inline ThreadBuffer& local() {
+    thread_local LocalBuffer buffer;
+    return buffer.get();
+}
+
+inline void writeString(std::ostream& os, const char* s) {
+    os << '"';
+    for (; s && *s; ++s) {
+        char c = *s;
+        if (c == '"' || c == '\\') {
+            os << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            os << buf;
+        } else {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+} // namespace detail
+
+/// @brief 当前时间, 纳秒
+inline std::uint64_t now() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// @brief 记录一段已经结束的时间区间
+/// @param start 开始时间, 由 now() 取得
+/// @param end 结束时间
+/// @param argName 附加参数名, 为空时不带参数
+inline void complete(const char* category, const char* name, std::uint64_t start, std::uint64_t end,
+                     const char* argName = nullptr, std::int64_t value = 0) {
+    detail::local().push('X', category, name, start, end > start ? end - start : 0, argName, value);
+}
+
+/// @brief 记录计数器的当前值 (队列长度等), 在时间线上显示为曲线
+inline void counter(const char* category, const char* name, std::int64_t value) {
+    detail::local().push('C', category, name, now(), 0, nullptr, value);
+}
+
+/// @brief 记录一个瞬间事件
+inline void instant(const char* category, const char* name, const char* argName = nullptr, std::int64_t value = 0) {
+    detail::local().push('i', category, name, now(), 0, argName, value);
+}
+
+/// @brief 设置当前线程在时间线上显示的名字
+inline void set_thread_name(std::string name) {
+    detail::ThreadBuffer& buffer = detail::local();
+    std::lock_guard<std::mutex> lock(detail::registry().mutex);
+    buffer.name = std::move(name);
+}
+
+/// @brief 记录从构造到析构的时间区间
+class Scope {
+public:
+    Scope(const char* category, const char* name) : category_(category), name_(name), argName_(nullptr), value_(0), start_(now()) {}
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope() {
+        complete(category_, name_, start_, now(), argName_, value_);
+    }
+
+    /// @brief 附加一个整数参数, 只保留最后一次设置的
+    void arg(const char* name, std::int64_t value) {
+        argName_ = name;
+        value_ = value;
+    }
+
+private:
+    const char* category_;
+    const char* name_;
+    const char* argName_;
+    std::int64_t value_;
+    std::uint64_t start_;
+};
+
+/// @brief 加独占锁, 锁被占用时把等待时间记录为一个事件
+template <typename Mutex>
+std::unique_lock<Mutex> lock(Mutex& mutex, const char* category, const char* name) {
+    std::unique_lock<Mutex> guard(mutex, std::try_to_lock);
+    if (!guard.owns_lock()) {
+        std::uint64_t start = now();
+        guard.lock();
+        complete(category, name, start, now());
+    }
+    return guard;
+}
+
+/// @brief 丢弃目前记录的所有事件
+inline void clear() {
+    detail::Registry& r = detail::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& buffer : r.buffers) buffer->clear();
+}
+
+/// @brief 以 Chrome trace 格式输出所有线程的事件, 记录可以同时进行
+inline void write_json(std::ostream& os) {
+    struct ThreadEvents {
+        std::uint32_t tid;
+        std::string name;
+        std::vector<detail::Event> events;
+    };
+    std::vector<ThreadEvents> threads;
+    {
+        detail::Registry& r = detail::registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (auto& buffer : r.buffers) {
+            threads.push_back(ThreadEvents{buffer->tid(), buffer->name, {}});
+            buffer->collect(threads.back().events);
+        }
+    }
+    // 时间戳从最早的事件开始计算, 单位微秒
+    std::uint64_t origin = UINT64_MAX;
+    for (const auto& thread : threads) {
+        for (const auto& event : thread.events) origin = std::min(origin, event.start);
+    }
+    auto micros = [](std::uint64_t ns) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.3f", static_cast<double>(ns) / 1000.0);
+        return std::string(buf);
+    };
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& thread : threads) {
+        if (!thread.name.empty()) {
+            os << (first ? "\n" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread.tid << ",\"args\":{\"name\":";
+            detail::writeString(os, thread.name.c_str());
+            os << "}}";
+            first = false;
+        }
+        for (const auto& event : thread.events) {
+            if (!event.name) continue;
+            os << (first ? "\n" : ",\n") << "{\"ph\":\"" << event.phase << "\",\"cat\":";
+            detail::writeString(os, event.category);
+            os << ",\"name\":";
+            detail::writeString(os, event.name);
+            os << ",\"pid\":1,\"tid\":" << thread.tid << ",\"ts\":" << micros(event.start - origin);
+            if (event.phase == 'X') os << ",\"dur\":" << micros(event.duration);
+            if (event.phase == 'i') os << ",\"s\":\"t\"";
+            if (event.phase == 'C') {
+                os << ",\"args\":{\"value\":" << event.value << "}";
+            } else if (event.argName) {
+                os << ",\"args\":{";
+                detail::writeString(os, event.argName);
+                os << ":" << event.value << "}";
+            }
+            os << "}";
+            first = false;
+        }
+    }
+    os << "\n]}\n";
+}
+
+/// @brief 把事件写入文件
+/// @return 是否写入成功
+inline bool save(const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) return false;
+    write_json(out);
+    return static_cast<bool>(out);
+}
+
+#else // MSTD_TRACE
+
+constexpr bool enabled = false;
+
+inline std::uint64_t now() {
+    return 0;
+}
+
+inline void complete(const char*, const char*, std::uint64_t, std::uint64_t, const char* = nullptr, std::int64_t = 0) {}
+
+inline void counter(const char*, const char*, std::int64_t) {}
+
+inline void instant(const char*, const char*, const char* = nullptr, std::int64_t = 0) {}
+
+inline void set_thread_name(const char*) {}
+
+inline void set_thread_name(const std::string&) {}
+
+class Scope {
+public:
+    Scope(const char*, const char*) {}
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    void arg(const char*, std::int64_t) {}
+};
+
+template <typename Mutex>
+std::unique_lock<Mutex> lock(Mutex& mutex, const char*, const char*) {
+    return std::unique_lock<Mutex>(mutex);
+}
+
+inline void clear() {}
+
+inline void write_json(std::ostream& os) {
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}\n";
+}
+
+/// @brief 未开启跟踪, 不写文件
+inline bool save(const std::string&) {
+    return false;
+}
+
+#endif // MSTD_TRACE
+
+} // namespace trace
+} // namespace mstd
@@ -1,235 +1,1023 @@
 #pragma once
 
 #include <string>
-#include <map>
-#include <any>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <limits>
 #include <fstream>
-#include <sstream>
 #include <stdexcept>
 #include <vector>
 #include <iostream>
+#include <charconv>
+#include <cstring>
+#include <istream>
+#include "string.hpp"
+#include "trace.hpp"
 
 namespace mstd {
 
+namespace yaml {
+
+// 一行去掉缩进和首尾空白后的内容, content 直接指向原始缓冲区
+struct Line {
+    int indent = 0;
+    mstd::string_view content;
+};
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// 把一行原始文本拆成缩进和内容; 空行和注释行返回 false
+// 行首行尾的空白通常只有几个字符, 直接逐个比较比调用 SIMD 查找更快
+inline bool parseLine(mstd::string_view raw, Line& line) {
+    const char* begin = raw.data();
+    const char* end = begin + raw.size();
+    const char* p = begin;
+    while (p != end && *p == ' ') ++p;
+    const int indent = static_cast<int>(p - begin);
+    while (p != end && isBlank(*p)) ++p;
+    while (end != p && isBlank(end[-1])) --end;
+    if (p == end || *p == '#') return false;
+    line.indent = indent;
+    line.content = mstd::string_view(p, static_cast<size_t>(end - p));
+    return true;
+}
+
+/// @brief 按行扫描整块文本, 跳过空行和注释行, 不做任何内存分配
+class LineScanner {
+public:
+    explicit LineScanner(mstd::string_view text) : text_(text), pos_(0) {}
+
+    /// @brief 读取下一个有内容的行
+    /// @param line 输出的行
+    /// @return 没有更多行时返回 false
+    bool next(Line& line) {
+        while (pos_ < text_.size()) {
+            size_t end = text_.find('\n', pos_);
+            if (end == mstd::string_view::npos) end = text_.size();
+            mstd::string_view raw = text_.substr(pos_, end - pos_);
+            pos_ = end + 1;
+            if (parseLine(raw, line)) return true;
+        }
+        return false;
+    }
+
+private:
+    mstd::string_view text_;
+    size_t pos_;
+};
+
+/// @brief 分块读取输入流并按行切分, 内存占用只和块大小 (以及最长的一行) 有关, 与文件大小无关
+/// 块末尾不完整的行会搬到缓冲区开头, 和下一块拼起来; 返回的行只在下一次调用 next() 之前有效
+class ChunkedLineReader {
+public:
+    explicit ChunkedLineReader(std::istream& in, size_t chunkSize = 64 * 1024)
+        : in_(in), buffer_(std::max<size_t>(chunkSize, 64)), begin_(0), end_(0), eof_(false) {}
+
+    bool next(Line& line) {
+        for (;;) {
+            mstd::string_view pending(buffer_.data() + begin_, end_ - begin_);
+            size_t newline = pending.find('\n');
+            if (newline != mstd::string_view::npos) {
+                begin_ += newline + 1;
+                if (parseLine(pending.substr(0, newline), line)) return true;
+                continue;
+            }
+            if (eof_) {
+                // 最后一行没有换行符
+                begin_ = end_;
+                return !pending.empty() && parseLine(pending, line);
+            }
+            refill();
+        }
+    }
+
+private:
+    void refill() {
+        size_t left = end_ - begin_;
+        if (begin_ > 0) {
+            std::memmove(buffer_.data(), buffer_.data() + begin_, left);
+            begin_ = 0;
+            end_ = left;
+        }
+        if (end_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2); // 一行比整个缓冲区还长
+        }
+        in_.read(buffer_.data() + end_, static_cast<std::streamsize>(buffer_.size() - end_));
+        std::streamsize n = in_.gcount();
+        end_ += static_cast<size_t>(n);
+        if (n == 0 || !in_) eof_ = true;
+    }
+
+    std::istream& in_;
+    std::vector<char> buffer_;
+    size_t begin_; // 未处理数据的起点
+    size_t end_;   // 已读入数据的终点
+    bool eof_;
+};
+
+// 是否为数组元素行: "-" 或 "- xxx"
+inline bool isSequenceItem(mstd::string_view content) {
+    return content.starts_with('-') && (content.size() == 1 || content[1] == ' ' || content[1] == '\t');
+}
+
+// 查找 key 和 value 之间的冒号, 冒号后面必须是空白或行尾 (这样 "http://x" 这样的值不会被误判)
+inline size_t findKeyDelimiter(mstd::string_view content) {
+    for (size_t pos = content.find(':'); pos != mstd::string_view::npos; pos = content.find(':', pos + 1)) {
+        if (pos + 1 == content.size() || content[pos + 1] == ' ' || content[pos + 1] == '\t') return pos;
+    }
+    return mstd::string_view::npos;
+}
+
+// 用 from_chars 整段解析数字, 不需要构造临时 std::string; 有多余字符或超出范围时返回 false
+template <typename T>
+bool tryParseNumber(mstd::string_view text, T& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// 以数字、"-数字"、".数字" 开头才当作数字, 避免 "nan"/"inf" 这类单词被 from_chars 解析成浮点数
+inline bool looksNumeric(mstd::string_view text) {
+    size_t i = text.starts_with('-') ? 1 : 0;
+    if (i < text.size() && text[i] == '.') ++i;
+    return i < text.size() && text[i] >= '0' && text[i] <= '9';
+}
+
+/// @brief 事件处理器的默认实现, 所有回调都为空; 继承后只需要覆盖关心的回调
+/// 解析器通过模板调用处理器, 不经过虚函数. 回调收到的字符串视图只在回调期间有效
+///
+/// 事件顺序: 整个文档是一个 start_mapping ... end_mapping;
+/// 对象成员是 on_key 后面跟一个值 (on_scalar / start_mapping / start_sequence);
+/// 数组元素直接是值, 没有 on_key
+struct EventHandler {
+    void start_mapping() {}
+    void end_mapping() {}
+
+    /// @param flow 是否为 [a, b] 形式的行内数组
+    void start_sequence(bool flow) { (void)flow; }
+    void end_sequence() {}
+
+    void on_key(mstd::string_view key) { (void)key; }
+
+    /// @param value 值的文本, 双引号已去掉
+    /// @param quoted 是否带双引号 (带引号的值总是字符串)
+    void on_scalar(mstd::string_view value, bool quoted) { (void)value; (void)quoted; }
+};
+
+/// @brief 逐行把 YAML 转成事件, 只保存当前的嵌套层级, 不保存已经处理过的内容
+/// @tparam Handler 提供 EventHandler 中全部回调的类型
+template <typename Handler>
+class EventParser {
+public:
+    explicit EventParser(Handler& handler) : handler_(handler) {
+        stack_.push_back({-1, false}); // 根层级, 永远不会出栈
+        handler_.start_mapping();
+    }
+
+    /// @brief 处理一行 (LineScanner / ChunkedLineReader 的输出)
+    void feed(const Line& line) {
+        const int indent = line.indent;
+        mstd::string_view content = line.content;
+        const bool isItem = isSequenceItem(content);
+
+        if (pending_.active) {
+            // key 下面的数组允许和 key 同缩进, "-" 元素的内容必须更深
+            if (isItem && (pending_.item ? indent > pending_.indent : indent >= pending_.indent)) {
+                handler_.start_sequence(false);
+                stack_.push_back({indent, true});
+            } else if (indent > pending_.indent) {
+                handler_.start_mapping();
+                stack_.push_back({indent, false});
+            } else {
+                // 没有子节点, 视为空对象
+                handler_.start_mapping();
+                handler_.end_mapping();
+            }
+            pending_.active = false;
+        }
+
+        // 处理缩进，退出嵌套层级; 与数组同缩进的普通行也意味着数组结束
+        while (stack_.size() > 1 && (stack_.back().indent > indent
+               || (stack_.back().sequence && stack_.back().indent == indent && !isItem))) {
+            close();
+        }
+
+        const Frame top = stack_.back();
+        if (isItem) {
+            if (!top.sequence) {
+                throw std::runtime_error("YAML array '-' without a parent key");
+            }
+            // YAML数组元素
+            int itemIndent = indent;
+            mstd::string_view item = content.substr(1).trim();
+            while (isSequenceItem(item)) {
+                // "- - x", 元素本身是数组, 后续和内层 "-" 对齐的行属于这个数组
+                itemIndent += static_cast<int>(item.data() - content.data());
+                handler_.start_sequence(false);
+                stack_.push_back({itemIndent, true});
+                content = item;
+                item = content.substr(1).trim();
+            }
+            if (item.empty()) {
+                // 元素内容在后面更深缩进的行里
+                pending_ = Pending{true, itemIndent, true};
+            } else if (findKeyDelimiter(item) != mstd::string_view::npos) {
+                // "- key: value", 后续和 key 对齐的行属于同一个元素
+                itemIndent += static_cast<int>(item.data() - content.data());
+                handler_.start_mapping();
+                stack_.push_back({itemIndent, false});
+                keyValue(item, itemIndent);
+            } else {
+                value(item);
+            }
+            return;
+        }
+
+        if (top.sequence) {
+            throw std::runtime_error("Invalid line: " + content.to_std_string());
+        }
+        keyValue(content, indent);
+    }
+
+    /// @brief 输入结束, 关闭所有还没结束的层级
+    void finish() {
+        if (pending_.active) {
+            handler_.start_mapping();
+            handler_.end_mapping();
+            pending_.active = false;
+        }
+        while (stack_.size() > 1) close();
+        handler_.end_mapping();
+    }
+
+private:
+    // 一层对象或数组, indent 为这一层条目的缩进
+    struct Frame {
+        int indent;
+        bool sequence;
+    };
+
+    // 值为空的 key (或内容为空的 "-" 元素), 要看到下一行才知道后面是对象还是数组
+    struct Pending {
+        bool active = false;
+        int indent = 0;
+        bool item = false;
+    };
+
+    void close() {
+        if (stack_.back().sequence) {
+            handler_.end_sequence();
+        } else {
+            handler_.end_mapping();
+        }
+        stack_.pop_back();
+    }
+
+    // 普通key: value
+    void keyValue(mstd::string_view content, int indent) {
+        size_t delimiterPos = findKeyDelimiter(content);
+        if (delimiterPos == mstd::string_view::npos) {
+            throw std::runtime_error("Invalid line: " + content.to_std_string());
+        }
+        handler_.on_key(content.substr(0, delimiterPos).trim());
+        mstd::string_view v = content.substr(delimiterPos + 1).trim();
+        if (v.empty()) {
+            pending_ = Pending{true, indent, false};
+            return;
+        }
+        value(v);
+    }
+
+    // 基础类型值或 [a, b] 形式的数组
+    void value(mstd::string_view v) {
+        if (v.front() == '[' && v.back() == ']') {
+            handler_.start_sequence(true);
+            for (mstd::string_view elem : v.substr(1, v.size() - 2).split(',')) {
+                elem = elem.trim();
+                if (!elem.empty()) scalar(elem);
+            }
+            handler_.end_sequence();
+            return;
+        }
+        scalar(v);
+    }
+
+    void scalar(mstd::string_view v) {
+        if (v.size() >= 2 && v.front() == '"' && v.back() == '"') {
+            handler_.on_scalar(v.substr(1, v.size() - 2), true);
+        } else {
+            handler_.on_scalar(v, false);
+        }
+    }
+
+    Handler& handler_;
+    std::vector<Frame> stack_;
+    Pending pending_;
+};
+
+/// @brief 在一整块内存 (例如读入或 mmap 的文件) 上产生事件
+template <typename Handler>
+void parseEvents(mstd::string_view text, Handler& handler) {
+    EventParser<Handler> parser(handler);
+    LineScanner scanner(text);
+    Line line;
+    while (scanner.next(line)) parser.feed(line);
+    parser.finish();
+}
+
+/// @brief 分块读取输入流并产生事件, 内存占用与文件大小无关
+/// @param chunkSize 每次读取的字节数
+template <typename Handler>
+void parseEvents(std::istream& in, Handler& handler, size_t chunkSize = 64 * 1024) {
+    EventParser<Handler> parser(handler);
+    ChunkedLineReader reader(in, chunkSize);
+    Line line;
+    while (reader.next(line)) parser.feed(line);
+    parser.finish();
+}
+
+/// @brief 分块读取文件并产生事件; 文件打不开时抛出 std::runtime_error
+template <typename Handler>
+void parseEventsFile(const std::string& filePath, Handler& handler, size_t chunkSize = 64 * 1024) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filePath);
+    }
+    parseEvents(file, handler, chunkSize);
+}
+
+// 节点类型
+enum class NodeType : std::uint8_t {
+    Null,
+    Bool,
+    Int,
+    Double,
+    String,
+    Object,
+    Array
+};
+
+inline const char* typeName(NodeType type) {
+    switch (type) {
+        case NodeType::Null: return "null";
+        case NodeType::Bool: return "bool";
+        case NodeType::Int: return "int";
+        case NodeType::Double: return "double";
+        case NodeType::String: return "string";
+        case NodeType::Object: return "object";
+        case NodeType::Array: return "array";
+    }
+    return "unknown";
+}
+
+static constexpr std::uint32_t noKey = 0xFFFFFFFFu;  // 数组元素和根节点没有 key
+static constexpr std::uint32_t noNode = 0xFFFFFFFFu;
+
+/// @brief 扁平存储的节点, 值直接放在联合体里
+/// 容器节点的子节点在 Document::children_ 中连续存放, 字符串节点指向原始文本
+struct Node {
+    NodeType type;
+    std::uint32_t key;    // 对象成员的 key id (已驻留)
+    std::uint32_t parent;
+    std::uint32_t first;  // 容器: children_ 中的起始位置; 字符串: 原始文本中的偏移
+    std::uint32_t count;  // 容器: 子节点数量; 字符串: 长度
+    union {
+        bool b;
+        std::int64_t i;
+        double d;
+    };
+};
+
+/// @brief 解析后的只读文档
+/// 所有节点放在一个数组里, key 全部驻留为整数 id, 字符串值直接引用原始文本, 不单独分配内存
+class Document {
+public:
+    static constexpr std::uint32_t root = 0;
+
+    /// @brief 解析文本, 文本的所有权转移给文档
+    /// 节点中的字符串偏移是 32 位的, 超过 4GB 的文本抛出 std::length_error
+    static std::shared_ptr<const Document> parse(std::string source) {
+        if (source.size() > maxSourceSize) throw std::length_error("YAML source larger than 4GB");
+        trace::Scope scope("yaml", "parse");
+        scope.arg("bytes", static_cast<std::int64_t>(source.size()));
+        auto doc = std::shared_ptr<Document>(new Document(std::move(source)));
+        doc->build();
+        return doc;
+    }
+
+    const Node& node(std::uint32_t index) const {
+        return nodes_[index];
+    }
+
+    /// @brief 进程内唯一的文档编号, 用于 YamlPath 判断缓存是否属于当前文档
+    std::uint32_t serial() const {
+        return serial_;
+    }
+
+    std::size_t nodeCount() const {
+        return nodes_.size();
+    }
+
+    /// @brief 第 index 个子节点 (对象成员按出现顺序)
+    std::uint32_t child(std::uint32_t parent, std::uint32_t index) const {
+        return children_[nodes_[parent].first + index].node;
+    }
+
+    /// @brief 查找对象成员, 找不到返回 noNode
+    std::uint32_t find(std::uint32_t parent, mstd::string_view key) const {
+        std::uint32_t id = keyId(key);
+        return id == noKey ? noNode : find(parent, id);
+    }
+
+    /// @brief 用已驻留的 key id 查找对象成员, 找不到返回 noNode
+    std::uint32_t find(std::uint32_t parent, std::uint32_t key) const {
+        const Node& n = nodes_[parent];
+        if (n.count <= linearLimit) {
+            // 小对象直接顺序比较 key id, 子节点信息是连续的, 比查哈希表更快; 重复 key 以第一个为准
+            for (const Child* c = children_.data() + n.first, *end = c + n.count; c != end; ++c) {
+                if (c->key == key) return c->node;
+            }
+            return noNode;
+        }
+        const std::uint64_t packed = pack(parent, key);
+        for (std::size_t i = slotOf(packed);; i = (i + 1) & (slots_.size() - 1)) {
+            if (slots_[i].key == packed) return slots_[i].node;
+            if (slots_[i].key == emptySlot) return noNode;
+        }
+    }
+
+    /// @brief key 文本对应的 id, 文档里没有出现过时返回 noKey
+    std::uint32_t keyId(mstd::string_view key) const {
+        return keySlots_.empty() ? noKey : keySlots_[keySlotOf(key, key.hash())].id;
+    }
+
+    mstd::string_view keyName(std::uint32_t key) const {
+        return keys_[key];
+    }
+
+    /// @brief 字符串节点的内容 (已去掉两侧的双引号)
+    mstd::string_view stringValue(std::uint32_t index) const {
+        const Node& n = nodes_[index];
+        return mstd::string_view(source_.data() + n.first, n.count);
+    }
+
+    /// @brief 文档占用的内存 (字节), 不含 shared_ptr 控制块
+    std::size_t memoryUsage() const {
+        return source_.capacity() + nodes_.capacity() * sizeof(Node) + children_.capacity() * sizeof(Child)
+             + keys_.capacity() * sizeof(mstd::string_view) + slots_.capacity() * sizeof(Slot)
+             + keySlots_.capacity() * sizeof(KeySlot);
+    }
+
+private:
+    struct Child {
+        std::uint32_t key;
+        std::uint32_t node;
+    };
+
+    struct Slot {
+        std::uint64_t key;
+        std::uint32_t node;
+    };
+
+    struct KeySlot {
+        std::uint32_t hash; // 哈希值的高 32 位, 先比较它再比较文本
+        std::uint32_t id;
+    };
+
+    static constexpr std::uint64_t emptySlot = ~0ull;
+    static constexpr std::uint64_t maxSourceSize = 0xFFFFFFFFull; // Node::first / Node::count 都是 uint32
+    static constexpr std::uint32_t linearLimit = 16; // 成员数不超过这个值的对象不进哈希索引
+
+    explicit Document(std::string source) : source_(std::move(source)), serial_(nextSerial()) {}
+
+    static std::uint32_t nextSerial() {
+        static std::atomic<std::uint32_t> counter{0};
+        return ++counter;
+    }
+
+    static std::uint64_t pack(std::uint32_t parent, std::uint32_t key) {
+        return (static_cast<std::uint64_t>(parent) << 32) | key;
+    }
+
+    std::size_t slotOf(std::uint64_t packed) const {
+        return static_cast<std::size_t>((packed * 0x9E3779B97F4A7C15ull) >> 32) & (slots_.size() - 1);
+    }
+
+    std::uint32_t addNode(NodeType type, std::uint32_t parent, std::uint32_t key) {
+        if (nodes_.size() >= noNode) throw std::length_error("YAML document too large");
+        Node n{};
+        n.type = type;
+        n.key = key;
+        n.parent = parent;
+        nodes_.push_back(n);
+        return static_cast<std::uint32_t>(nodes_.size() - 1);
+    }
+
+    // key 驻留表, 开放寻址; 返回 key 所在的槽位, 不存在时返回应该插入的空槽
+    std::size_t keySlotOf(mstd::string_view key, std::size_t hash) const {
+        const std::size_t mask = keySlots_.size() - 1;
+        const std::uint32_t tag = static_cast<std::uint32_t>(static_cast<std::uint64_t>(hash) >> 32);
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            const KeySlot& slot = keySlots_[i];
+            if (slot.id == noKey || (slot.hash == tag && keys_[slot.id] == key)) return i;
+        }
+    }
+
+    std::uint32_t intern(mstd::string_view key) {
+        if ((keys_.size() + 1) * 2 > keySlots_.size()) {
+            // 负载超过一半时翻倍并重新插入
+            std::vector<KeySlot> old(std::max<std::size_t>(keySlots_.size() * 2, 64), KeySlot{0, noKey});
+            old.swap(keySlots_);
+            for (std::uint32_t id = 0; id < keys_.size(); ++id) {
+                std::size_t hash = keys_[id].hash();
+                keySlots_[keySlotOf(keys_[id], hash)] = KeySlot{static_cast<std::uint32_t>(static_cast<std::uint64_t>(hash) >> 32), id};
+            }
+        }
+        std::size_t hash = key.hash();
+        KeySlot& slot = keySlots_[keySlotOf(key, hash)];
+        if (slot.id == noKey) {
+            slot = KeySlot{static_cast<std::uint32_t>(static_cast<std::uint64_t>(hash) >> 32), static_cast<std::uint32_t>(keys_.size())};
+            keys_.push_back(key);
+        }
+        return slot.id;
+    }
+
+    // DOM 构建器只是事件的一个消费者; 事件里的字符串视图都指向 source_, 这里只记录偏移
+    class Builder : public EventHandler {
+    public:
+        explicit Builder(Document& doc) : doc_(doc), key_(noKey) {}
+
+        void start_mapping() {
+            open(NodeType::Object, false);
+        }
+
+        void end_mapping() {
+            stack_.pop_back();
+        }
+
+        void start_sequence(bool flow) {
+            open(NodeType::Array, flow);
+        }
+
+        void end_sequence() {
+            stack_.pop_back();
+        }
+
+        void on_key(mstd::string_view key) {
+            key_ = doc_.intern(key);
+        }
+
+        void on_scalar(mstd::string_view value, bool quoted) {
+            std::uint32_t parent = stack_.back().node;
+            std::uint32_t key = takeKey();
+            // 行内数组 [a, b] 的元素统一按字符串保存
+            if (quoted || stack_.back().flow) {
+                doc_.addString(value, parent, key);
+            } else {
+                doc_.addValue(value, parent, key);
+            }
+        }
+
+    private:
+        struct Open {
+            std::uint32_t node;
+            bool flow;
+        };
+
+        std::uint32_t takeKey() {
+            std::uint32_t key = key_;
+            key_ = noKey;
+            return key;
+        }
+
+        void open(NodeType type, bool flow) {
+            std::uint32_t parent = stack_.empty() ? noNode : stack_.back().node;
+            stack_.push_back({doc_.addNode(type, parent, takeKey()), flow});
+        }
+
+        Document& doc_;
+        std::vector<Open> stack_;
+        std::uint32_t key_; // 等待值的 key
+    };
+
+    void build() {
+        // 按行数和逗号数 (行内数组的元素) 估计节点数, 多留 1/8 给 "- key: value" 这样一行两个节点的情况;
+        // 估计不足时按倍数增长. 以前按文本大小预留, 节点数组要占到文本的两倍左右
+        size_t estimate = 2;
+        for (char c : source_) estimate += (c == '\n') | (c == ',');
+        nodes_.reserve(estimate + estimate / 8);
+        {
+            trace::Scope scope("yaml", "events");
+            Builder builder(*this);
+            parseEvents(mstd::string_view(source_.data(), source_.size()), builder);
+            scope.arg("nodes", static_cast<std::int64_t>(nodes_.size()));
+        }
+        trace::Scope scope("yaml", "finalize");
+        // 收缩需要再复制一份, 只在浪费较多时才做
+        if (nodes_.capacity() - nodes_.size() > nodes_.size() / 4) nodes_.shrink_to_fit();
+        finalize();
+    }
+
+    // 基础类型: bool / 整数 / 浮点数 / 字符串
+    // 数字用 from_chars 整段解析, 支持负数和指数, "1.2.3" 这样的值按字符串处理
+    void addValue(mstd::string_view value, std::uint32_t parent, std::uint32_t key) {
+        std::int64_t i;
+        double d;
+        if (value == "true" || value == "false") {
+            nodes_[addNode(NodeType::Bool, parent, key)].b = value == "true";
+        } else if (looksNumeric(value) && tryParseNumber(value, i)) {
+            nodes_[addNode(NodeType::Int, parent, key)].i = i;
+        } else if (looksNumeric(value) && tryParseNumber(value, d)) {
+            nodes_[addNode(NodeType::Double, parent, key)].d = d;
+        } else {
+            addString(value, parent, key);
+        }
+    }
+
+    void addString(mstd::string_view value, std::uint32_t parent, std::uint32_t key) {
+        Node& n = nodes_[addNode(NodeType::String, parent, key)];
+        n.first = static_cast<std::uint32_t>(value.data() - source_.data());
+        n.count = static_cast<std::uint32_t>(value.size());
+    }
+
+    // 解析结束后: 按父节点做一次计数排序, 让每个容器的子节点连续存放, 再为大对象建立 (父节点, key) 的哈希索引
+    void finalize() {
+        for (Node& n : nodes_) {
+            if (n.type == NodeType::Object || n.type == NodeType::Array) n.count = 0;
+        }
+        for (const Node& n : nodes_) {
+            if (n.parent != noNode) nodes_[n.parent].count++;
+        }
+        std::uint32_t offset = 0;
+        for (Node& n : nodes_) {
+            if (n.type == NodeType::Object || n.type == NodeType::Array) {
+                n.first = offset;
+                offset += n.count;
+                n.count = 0;
+            }
+        }
+        children_.resize(offset);
+        for (std::uint32_t i = 1; i < nodes_.size(); ++i) {
+            Node& parent = nodes_[nodes_[i].parent];
+            children_[parent.first + parent.count++] = Child{nodes_[i].key, i};
+        }
+
+        std::size_t members = 0;
+        for (const Node& n : nodes_) {
+            if (n.type == NodeType::Object && n.count > linearLimit) members += n.count;
+        }
+        if (members == 0) return;
+        std::size_t capacity = 16;
+        while (capacity < members * 2) capacity <<= 1;
+        slots_.assign(capacity, Slot{emptySlot, noNode});
+        for (std::uint32_t i = 1; i < nodes_.size(); ++i) {
+            const Node& n = nodes_[i];
+            if (n.key == noKey || nodes_[n.parent].count <= linearLimit) continue;
+            const std::uint64_t packed = pack(n.parent, n.key);
+            std::size_t slot = slotOf(packed);
+            // 重复的 key 以第一次出现为准, 与小对象的顺序查找一致
+            while (slots_[slot].key != emptySlot && slots_[slot].key != packed) slot = (slot + 1) & (capacity - 1);
+            if (slots_[slot].key == emptySlot) slots_[slot] = Slot{packed, i};
+        }
+    }
+
+    std::string source_; // 原始文本, 字符串节点和 key 都是指向它的视图
+    std::uint32_t serial_;
+    std::vector<Node> nodes_;
+    std::vector<Child> children_;
+    std::vector<mstd::string_view> keys_; // key id -> key 文本
+    std::vector<KeySlot> keySlots_; // key 文本 -> key id, 开放寻址
+    std::vector<Slot> slots_; // 大对象的 (父节点, key id) -> 节点, 开放寻址
+};
+
+// 路径中的一段: key 或者 [下标]
+struct PathSegment {
+    mstd::string_view key;
+    std::uint32_t index = 0;
+    bool isIndex = false;
+};
+
+/// @brief 取出路径的下一段, 语法为 "a.b[3].c"; 路径格式错误时抛出 std::invalid_argument
+/// @param rest 剩余的路径, 会被前移
+/// @param segment 输出的一段
+/// @return 路径已经结束时返回 false
+inline bool nextPathSegment(mstd::string_view& rest, PathSegment& segment) {
+    if (rest.empty()) return false;
+    auto fail = [&rest]() -> bool {
+        throw std::invalid_argument("Invalid YAML path near: " + rest.to_std_string());
+    };
+    if (rest.front() == '[') {
+        size_t close = rest.find(']');
+        // 下标必须整段都是数字, "[3x]" / "[-1]" 都是错误的路径
+        if (close == mstd::string_view::npos || !tryParseNumber(rest.substr(1, close - 1), segment.index)) return fail();
+        // "]" 之后只能是路径结尾、"." 或下一个 "["
+        if (close + 1 < rest.size() && rest[close + 1] != '.' && rest[close + 1] != '[') return fail();
+        segment.isIndex = true;
+        segment.key = mstd::string_view();
+        rest.remove_prefix(close + 1);
+    } else {
+        size_t end = rest.find_first_of(".[");
+        if (end == 0) return fail();
+        if (end == mstd::string_view::npos) end = rest.size();
+        segment.key = rest.substr(0, end);
+        segment.isIndex = false;
+        rest.remove_prefix(end);
+    }
+    // 段之间用 '.' 分隔, '[' 可以直接跟在后面
+    if (!rest.empty() && rest.front() == '.') {
+        rest.remove_prefix(1);
+        if (rest.empty() || rest.front() == '.' || rest.front() == '[') return fail();
+    }
+    return true;
+}
+
+/// @brief 在文档中走一步, 找不到时返回 noNode
+inline std::uint32_t stepPath(const Document& doc, std::uint32_t node, const PathSegment& segment) {
+    const Node& n = doc.node(node);
+    if (segment.isIndex) {
+        return (n.type == NodeType::Array && segment.index < n.count) ? doc.child(node, segment.index) : noNode;
+    }
+    return n.type == NodeType::Object ? doc.find(node, segment.key) : noNode;
+}
+
+}
+
+/// @brief 预先切分好的路径, 如 "server.features.enable_feature_x" 或 "items[3].name"
+/// 从文档根节点解析时会缓存结果, 同一文档上重复查找是 O(1); 可以在多个线程间共享
+class YamlPath {
+public:
+    explicit YamlPath(mstd::string_view path) : text_(path.to_std_string()), cache_(0) {
+        // 各段的 key 指向 text_ 自身, 所以要在 text_ 确定之后再切分
+        mstd::string_view rest(text_.data(), text_.size());
+        yaml::PathSegment segment;
+        while (yaml::nextPathSegment(rest, segment)) {
+            segments_.push_back(segment);
+        }
+    }
+
+    explicit YamlPath(const char* path) : YamlPath(mstd::string_view(path)) {}
+
+    YamlPath(const YamlPath& other) : YamlPath(mstd::string_view(other.text_.data(), other.text_.size())) {}
+
+    YamlPath& operator=(const YamlPath& other) {
+        if (this != &other) {
+            YamlPath copy(other);
+            text_.swap(copy.text_);
+            segments_.swap(copy.segments_);
+            cache_.store(0, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    const std::string& str() const {
+        return text_;
+    }
+
+private:
+    friend class YamlReader;
+
+    /// @brief 从 from 节点开始解析路径, 找不到返回 noNode
+    std::uint32_t resolve(const yaml::Document& doc, std::uint32_t from) const {
+        if (from != yaml::Document::root) return walk(doc, from);
+        // 缓存打包为 (文档编号 << 32 | 节点), 用一个原子变量保存, 读写都不需要加锁
+        std::uint64_t cached = cache_.load(std::memory_order_relaxed);
+        if (cached >> 32 == doc.serial()) return static_cast<std::uint32_t>(cached);
+        std::uint32_t node = walk(doc, from);
+        if (node != yaml::noNode) {
+            cache_.store((static_cast<std::uint64_t>(doc.serial()) << 32) | node, std::memory_order_relaxed);
+        }
+        return node;
+    }
+
+    std::uint32_t walk(const yaml::Document& doc, std::uint32_t node) const {
+        for (const auto& segment : segments_) {
+            node = yaml::stepPath(doc, node, segment);
+            if (node == yaml::noNode) break;
+        }
+        return node;
+    }
+
+    std::string text_;
+    std::vector<yaml::PathSegment> segments_;
+    mutable std::atomic<std::uint64_t> cache_;
+};
+
+/// @brief YAML 读取器, 本身只是 (文档, 节点) 的游标
+/// 拷贝只增加一次引用计数, getObject / getArray 不再复制子树
 class YamlReader {
 public:
-    // 构造函数，接受文件路径或父对象的数据
-    explicit YamlReader(const std::string& filePath) {
+    // 构造函数，接受文件路径
+    explicit YamlReader(const std::string& filePath) : node_(yaml::Document::root) {
         parseFile(filePath);
     }
 
-    explicit YamlReader(const std::map<std::string, std::any>& objectData) : data(objectData) {}
+    // 从内存中的文本解析
+    static YamlReader fromString(mstd::string_view text) {
+        return YamlReader(yaml::Document::parse(text.to_std_string()), yaml::Document::root);
+    }
+
+    // 从内存中的文本解析, 文本的所有权转移给文档, 不复制
+    static YamlReader fromBuffer(std::string text) {
+        return YamlReader(yaml::Document::parse(std::move(text)), yaml::Document::root);
+    }
 
     // 获取值的方法，支持模板化返回类型
     template <typename T>
     T getValue(const std::string& key) const {
-        auto it = data.find(key);
-        if (it == data.end()) {
+        std::uint32_t index = find(key);
+        if (index == yaml::noNode) {
             throw std::runtime_error("Key not found: " + key);
         }
+        return convert<T>(index, key);
+    }
 
-        // 检查类型是否匹配
-        if (it->second.type() != typeid(T)) {
-            throw std::runtime_error("Type mismatch for key: " + key);
-        }
-
-        if constexpr (std::is_same_v<T, std::string>) {
-            std::string value = std::any_cast<std::string>(it->second);
-            if (!value.empty() && value.front() == '"' && value.back() == '"') {
-            value = value.substr(1, value.size() - 2);
-            }
-            return value;
-        } else {
-            return std::any_cast<T>(it->second);
-        }
+    /// @brief 把当前节点本身转换为指定类型 (用于基础类型的数组元素)
+    template <typename T>
+    T as() const {
+        return convert<T>(node_, "<node>");
     }
 
     // 获取嵌套对象的方法
     YamlReader getObject(const std::string& key) const {
-        auto it = data.find(key);
-        if (it == data.end() || it->second.type() != typeid(std::map<std::string, std::any>)) {
+        std::uint32_t index = find(key);
+        if (index == yaml::noNode || doc_->node(index).type != yaml::NodeType::Object) {
             throw std::runtime_error("Object not found or invalid: " + key);
         }
-        return YamlReader(std::any_cast<const std::map<std::string, std::any>&>(it->second));
+        return YamlReader(doc_, index);
     }
 
-    // 获取数组类型的方法
+    // 获取数组类型的方法, 每个元素都是指向原文档的游标
     std::vector<YamlReader> getArray(const std::string& key) const {
-        auto it = data.find(key);
-        if (it == data.end()) {
+        std::uint32_t index = find(key);
+        if (index == yaml::noNode) {
             throw std::runtime_error("Array not found: " + key);
         }
-        // 支持 vector<map> 或 vector<any>（兼容更广泛的YAML数组）
-        if (it->second.type() == typeid(std::vector<std::map<std::string, std::any>>)) {
-            const auto& vec = std::any_cast<const std::vector<std::map<std::string, std::any>>&>(it->second);
-            std::vector<YamlReader> result;
-            for (const auto& obj : vec) {
-                result.emplace_back(obj);
-            }
-            return result;
-        } else if (it->second.type() == typeid(std::vector<std::any>)) {
-            const auto& vec = std::any_cast<const std::vector<std::any>&>(it->second);
-            std::vector<YamlReader> result;
-            for (const auto& obj : vec) {
-                if (obj.type() == typeid(std::map<std::string, std::any>)) {
-                    result.emplace_back(std::any_cast<const std::map<std::string, std::any>&>(obj));
-                } else {
-                    // 支持基础类型数组
-                    std::map<std::string, std::any> tmp;
-                    tmp["value"] = obj;
-                    result.emplace_back(tmp);
-                }
-            }
-            return result;
-        } else {
+        const yaml::Node& n = doc_->node(index);
+        if (n.type != yaml::NodeType::Array) {
             throw std::runtime_error("Array type not supported for key: " + key);
         }
+        std::vector<YamlReader> result;
+        result.reserve(n.count);
+        for (std::uint32_t i = 0; i < n.count; ++i) {
+            result.push_back(YamlReader(doc_, doc_->child(index, i)));
+        }
+        return result;
     }
 
     // 检查是否有某个key
     bool hasKey(const std::string& key) const {
-        return data.find(key) != data.end();
+        return find(key) != yaml::noNode;
+    }
+
+    /// @brief 按路径读取值, 如 get<bool>("server.features.enable_feature_x") 或 get<std::string>("items[3].name")
+    template <typename T>
+    T get(mstd::string_view path) const {
+        return convert<T>(resolve(path), path);
+    }
+
+    /// @brief 按预先切分好的路径读取值, 重复查找时直接命中缓存
+    template <typename T>
+    T get(const YamlPath& path) const {
+        return convert<T>(resolve(path), path.str());
+    }
+
+    /// @brief 按路径获取子节点的游标 (对象、数组或基础类型都可以)
+    YamlReader at(mstd::string_view path) const {
+        return YamlReader(doc_, resolve(path));
+    }
+
+    YamlReader at(const YamlPath& path) const {
+        return YamlReader(doc_, resolve(path));
+    }
+
+    /// @brief 路径是否存在
+    bool has(mstd::string_view path) const {
+        return resolveOrNull(path) != yaml::noNode;
+    }
+
+    bool has(const YamlPath& path) const {
+        return path.resolve(*doc_, node_) != yaml::noNode;
+    }
+
+    /// @brief 当前节点的类型
+    yaml::NodeType type() const {
+        return doc_->node(node_).type;
+    }
+
+    /// @brief 对象的成员数量或数组的长度, 基础类型返回 0
+    std::size_t size() const {
+        const yaml::Node& n = doc_->node(node_);
+        return (n.type == yaml::NodeType::Object || n.type == yaml::NodeType::Array) ? n.count : 0;
+    }
+
+    /// @brief 底层文档
+    const std::shared_ptr<const yaml::Document>& document() const {
+        return doc_;
+    }
+
+    /// @brief 当前节点在文档中的下标
+    std::uint32_t node() const {
+        return node_;
     }
 
 private:
-    std::map<std::string, std::any> data;
+    YamlReader(std::shared_ptr<const yaml::Document> doc, std::uint32_t node) : doc_(std::move(doc)), node_(node) {}
 
-    // 解析文件
+    std::shared_ptr<const yaml::Document> doc_;
+    std::uint32_t node_;
+
+    // 解析文件: 整个文件一次读入内存, 之后只在这块内存上单遍扫描
     void parseFile(const std::string& filePath) {
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
-            std::cerr << "[YamlReader] Failed to open file: " << filePath << std::endl;
-            return; // 不抛异常，直接返回，data保持为空
-        }
-
-        std::string line;
-        std::vector<std::map<std::string, std::any>*> stack;
-        stack.push_back(&data); // 根层级
-        int previousIndent = 0;
-        std::vector<std::vector<std::map<std::string, std::any>>*> array_stack;
-        std::vector<int> array_indent_stack; // 记录每个数组的起始缩进
-
-        while (std::getline(file, line)) {
-            int currentIndent = countIndent(line);
-            trim(line);
-            if (line.empty() || line[0] == '#') continue;
-
-            // 处理缩进，退出嵌套层级
-            while (currentIndent < previousIndent) {
-                // 只有当当前缩进小于数组起始缩进时才pop
-                while (!array_indent_stack.empty() && currentIndent < array_indent_stack.back()) {
-                    array_stack.pop_back();
-                    array_indent_stack.pop_back();
-                }
-                if (stack.size() > 1) stack.pop_back();
-                previousIndent -= 2;
+        std::string buffer;
+        {
+            trace::Scope scope("yaml", "read_file");
+            std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) {
+                std::cerr << "[YamlReader] Failed to open file: " << filePath << std::endl;
+                doc_ = yaml::Document::parse(std::string()); // 不抛异常，返回空文档
+                return;
             }
+            buffer.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.resize(static_cast<size_t>(file.gcount()));
+        }
+        doc_ = yaml::Document::parse(std::move(buffer));
+    }
 
-            if (line[0] == '-') {
-                // YAML数组元素
-                std::string item = line.substr(1);
-                trim(item);
-                if (array_stack.empty()) {
-                    throw std::runtime_error("YAML array '-' without a parent key");
-                }
-                std::map<std::string, std::any> obj;
-                array_stack.back()->push_back(obj);
-                stack.push_back(&array_stack.back()->back());
-                if (!item.empty()) {
-                    size_t delimiterPos = item.find(":");
-                    if (delimiterPos == std::string::npos) throw std::runtime_error("Invalid array item: " + item);
-                    std::string key = item.substr(0, delimiterPos);
-                    std::string value = item.substr(delimiterPos + 1);
-                    trim(key); trim(value);
-                    if (value.empty()) {
-                        (*stack.back())[key] = std::map<std::string, std::any>();
-                        stack.push_back(&std::any_cast<std::map<std::string, std::any>&>((*stack.back())[key]));
-                    } else {
-                        (*stack.back())[key] = value;
-                    }
-                }
-                previousIndent = currentIndent;
-                continue;
-            }
+    // 按路径查找, 边切分边查找, 不产生任何临时对象
+    std::uint32_t resolveOrNull(mstd::string_view path) const {
+        std::uint32_t node = node_;
+        yaml::PathSegment segment;
+        while (yaml::nextPathSegment(path, segment)) {
+            // 找不到之后仍然切分完剩余部分, 保证格式错误的路径总是抛出异常
+            if (node != yaml::noNode) node = yaml::stepPath(*doc_, node, segment);
+        }
+        return node;
+    }
 
-            // 普通key: value
-            size_t delimiterPos = line.find(":");
-            if (delimiterPos == std::string::npos) throw std::runtime_error("Invalid line: " + line);
-            std::string key = line.substr(0, delimiterPos);
-            std::string value = line.substr(delimiterPos + 1);
-            trim(key); trim(value);
-            if (value.empty()) {
-                // 判断下一行是否是数组（跳过注释和空行）
-                std::streampos pos = file.tellg();
-                std::string nextLine;
-                bool isArray = false;
-                while (std::getline(file, nextLine)) {
-                    trim(nextLine);
-                    if (nextLine.empty() || nextLine[0] == '#') continue;
-                    if (nextLine[0] == '-') isArray = true;
-                    break;
-                }
-                file.clear();
-                file.seekg(pos);
-                if (isArray) {
-                    (*stack.back())[key] = std::vector<std::map<std::string, std::any>>();
-                    array_stack.push_back(&std::any_cast<std::vector<std::map<std::string, std::any>>&>((*stack.back())[key]));
-                    array_indent_stack.push_back(currentIndent + 2); // 记录数组的起始缩进
-                } else {
-                    (*stack.back())[key] = std::map<std::string, std::any>();
-                    stack.push_back(&std::any_cast<std::map<std::string, std::any>&>((*stack.back())[key]));
-                }
-            } else {
-                // 支持基础类型数组（如 arr: [1,2,3]）
-                if (value.front() == '[' && value.back() == ']') {
-                    std::vector<std::any> arr;
-                    std::string inner = value.substr(1, value.size() - 2);
-                    std::stringstream ss(inner);
-                    std::string elem;
-                    while (std::getline(ss, elem, ',')) {
-                        trim(elem);
-                        if (!elem.empty()) arr.push_back(elem);
-                    }
-                    (*stack.back())[key] = arr;
-                } else {
-                    if (value == "true" || value == "false") {
-                        stack.back()->emplace(key, value == "true");
-                    } else if (value.find_first_not_of("0123456789") == std::string::npos) {
-                        stack.back()->emplace(key, std::stoi(value));
-                    } else if (value.find_first_not_of("0123456789.") == std::string::npos) {
-                        stack.back()->emplace(key, std::stod(value));
-                    } else {
-                        stack.back()->emplace(key, value);
-                    }
-                }
-            }
-            previousIndent = currentIndent;
+    std::uint32_t resolve(mstd::string_view path) const {
+        std::uint32_t node = resolveOrNull(path);
+        if (node == yaml::noNode) {
+            throw std::runtime_error("Path not found: " + path.to_std_string());
         }
+        return node;
     }
 
-    // 计算缩进级别
-    int countIndent(const std::string& line) const {
-        int count = 0;
-        for (char c : line) {
-            if (c == ' ') {
-                count++;
-            } else {
-                break;
-            }
+    std::uint32_t resolve(const YamlPath& path) const {
+        std::uint32_t node = path.resolve(*doc_, node_);
+        if (node == yaml::noNode) {
+            throw std::runtime_error("Path not found: " + path.str());
         }
-        return count;
+        return node;
     }
 
-    // 去除字符串前后的空格
-    void trim(std::string& str) const {
-        size_t first = str.find_first_not_of(" \t\n\r");
-        size_t last = str.find_last_not_of(" \t\n\r");
-        if (first == std::string::npos || last == std::string::npos) {
-            str.clear();
+    std::uint32_t find(mstd::string_view key) const {
+        const yaml::Node& n = doc_->node(node_);
+        if (n.type == yaml::NodeType::Object) {
+            return doc_->find(node_, key);
+        }
+        // 基础类型的数组元素, 兼容以前 {"value": 元素} 的访问方式
+        if (n.type != yaml::NodeType::Array && key == "value") {
+            return node_;
+        }
+        return yaml::noNode;
+    }
+
+    // key 只用于异常信息, 成功时不构造字符串
+    template <typename T>
+    T convert(std::uint32_t index, mstd::string_view key) const {
+        const yaml::Node& n = doc_->node(index);
+        if constexpr (std::is_same_v<T, bool>) {
+            if (n.type == yaml::NodeType::Bool) return n.b;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            if (n.type == yaml::NodeType::String) return doc_->stringValue(index).to_std_string();
+        } else if constexpr (std::is_same_v<T, mstd::string_view>) {
+            // 视图指向文档内部, 只要任意一个 YamlReader 还持有该文档就有效
+            if (n.type == yaml::NodeType::String) return doc_->stringValue(index);
+        } else if constexpr (std::is_same_v<T, mstd::string>) {
+            if (n.type == yaml::NodeType::String) return mstd::string(doc_->stringValue(index));
+        } else if constexpr (std::is_integral_v<T>) {
+            if (n.type == yaml::NodeType::Int) {
+                if (n.i < static_cast<std::int64_t>(std::numeric_limits<T>::min())
+                    || (n.i > 0 && static_cast<std::uint64_t>(n.i) > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))) {
+                    throw std::out_of_range("Value out of range for key: " + key.to_std_string());
+                }
+                return static_cast<T>(n.i);
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            if (n.type == yaml::NodeType::Double) return static_cast<T>(n.d);
+            if (n.type == yaml::NodeType::Int) return static_cast<T>(n.i);
         } else {
-            str = str.substr(first, last - first + 1);
+            static_assert(std::is_same_v<T, void>, "YamlReader: unsupported value type");
         }
+        // 检查类型是否匹配
+        throw std::runtime_error("Type mismatch for key: " + key.to_std_string());
     }
 };
 
-}
\ No newline at end of file
+}
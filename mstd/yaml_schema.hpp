@@ -0,0 +1,239 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <stdexcept>
+#include <limits>
+#include "yaml.hpp"
+
+namespace mstd {
+namespace yaml {
+
+/// @brief 结构体成员和 YAML key 的绑定
+/// @tparam Class 结构体类型
+/// @tparam Member 成员类型
+template <typename Class, typename Member>
+struct Field {
+    const char* name;
+    Member Class::* member;
+    bool required;
+
+    /// @brief 标记为可选: 缺少这个 key 时保留成员原来的值
+    constexpr Field optional() const {
+        return Field{name, member, false};
+    }
+};
+
+/// @brief 声明一个字段, 默认是必填的 (std::optional 成员除外)
+template <typename Class, typename Member>
+constexpr Field<Class, Member> field(const char* name, Member Class::* member) {
+    return Field<Class, Member>{name, member, true};
+}
+
+/// @brief 结构体的字段列表, 用户需要为自己的类型特化:
+///
+///     template <> struct mstd::yaml::schema<ServerConfig> {
+///         static constexpr auto fields = std::make_tuple(
+///             mstd::yaml::field("host", &ServerConfig::host),
+///             mstd::yaml::field("port", &ServerConfig::port),
+///             mstd::yaml::field("timeout", &ServerConfig::timeout).optional());
+///     };
+template <typename T>
+struct schema;
+
+namespace detail {
+
+template <typename T, typename = void>
+struct has_schema : std::false_type {};
+
+template <typename T>
+struct has_schema<T, std::void_t<decltype(schema<T>::fields)>> : std::true_type {};
+
+template <typename T>
+struct is_vector : std::false_type {};
+
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+struct is_optional : std::false_type {};
+
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+struct is_string_map : std::false_type {};
+
+template <typename T, typename C, typename A>
+struct is_string_map<std::map<std::string, T, C, A>> : std::true_type {};
+
+template <typename T>
+struct dependent_false : std::false_type {};
+
+// 解析过程中的路径, 只在出错时才拼成字符串
+struct Trail {
+    const Trail* parent;
+    mstd::string_view key; // 为空时表示数组下标
+    std::size_t index;
+
+    std::string str() const {
+        std::string out = parent ? parent->str() : std::string();
+        if (!parent) return out;
+        if (!key.empty()) {
+            if (!out.empty()) out += '.';
+            out += key.to_std_string();
+        } else {
+            out += '[' + std::to_string(index) + ']';
+        }
+        return out;
+    }
+
+    std::string where() const {
+        std::string path = str();
+        return path.empty() ? std::string("<root>") : path;
+    }
+};
+
+// 每个 schema 类型在进程内的编号, 第一次解码该类型时分配
+inline std::size_t nextSchemaSlot() {
+    static std::atomic<std::size_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+std::size_t schemaSlot() {
+    static const std::size_t slot = nextSchemaSlot();
+    return slot;
+}
+
+class Decoder {
+public:
+    explicit Decoder(const Document& doc) : doc_(doc) {}
+
+    template <typename T>
+    void decode(std::uint32_t node, T& out, const Trail& trail) {
+        const Node& n = doc_.node(node);
+        if constexpr (is_optional<T>::value) {
+            out.emplace();
+            decode(node, *out, trail);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            expect(n, NodeType::Bool, trail);
+            out = n.b;
+        } else if constexpr (std::is_integral_v<T>) {
+            expect(n, NodeType::Int, trail);
+            if (n.i < static_cast<std::int64_t>(std::numeric_limits<T>::min())
+                || (n.i > 0 && static_cast<std::uint64_t>(n.i) > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))) {
+                throw std::out_of_range(trail.where() + ": value out of range");
+            }
+            out = static_cast<T>(n.i);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            if (n.type == NodeType::Int) {
+                out = static_cast<T>(n.i);
+            } else {
+                expect(n, NodeType::Double, trail);
+                out = static_cast<T>(n.d);
+            }
+        } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, mstd::string>) {
+            expect(n, NodeType::String, trail);
+            mstd::string_view v = doc_.stringValue(node);
+            out = T(v.data(), v.size());
+        } else if constexpr (is_vector<T>::value) {
+            expect(n, NodeType::Array, trail);
+            out.clear();
+            out.reserve(n.count);
+            for (std::uint32_t i = 0; i < n.count; ++i) {
+                // 先解码到局部变量再放进去, 这样 std::vector<bool> 也能用
+                typename T::value_type value{};
+                decode(doc_.child(node, i), value, Trail{&trail, mstd::string_view(), i});
+                out.push_back(std::move(value));
+            }
+        } else if constexpr (is_string_map<T>::value) {
+            expect(n, NodeType::Object, trail);
+            out.clear();
+            for (std::uint32_t i = 0; i < n.count; ++i) {
+                std::uint32_t child = doc_.child(node, i);
+                mstd::string_view key = doc_.keyName(doc_.node(child).key);
+                auto inserted = out.try_emplace(key.to_std_string());
+                // 重复的 key 以第一次出现为准, 与 YamlReader 的查找一致
+                if (!inserted.second) continue;
+                decode(child, inserted.first->second, Trail{&trail, key, i});
+            }
+        } else if constexpr (has_schema<T>::value) {
+            expect(n, NodeType::Object, trail);
+            decodeFields(node, out, trail, schema<T>::fields, std::make_index_sequence<std::tuple_size_v<std::decay_t<decltype(schema<T>::fields)>>>{});
+        } else {
+            static_assert(dependent_false<T>::value, "mstd::yaml::decode: unsupported member type, specialize mstd::yaml::schema<T>");
+        }
+    }
+
+private:
+    void expect(const Node& n, NodeType type, const Trail& trail) const {
+        if (n.type != type) {
+            throw std::runtime_error(trail.where() + ": type mismatch (expected " + typeName(type) + ", got " + typeName(n.type) + ")");
+        }
+    }
+
+    template <typename T, typename Fields, std::size_t... I>
+    void decodeFields(std::uint32_t node, T& out, const Trail& trail, const Fields& fields, std::index_sequence<I...> seq) {
+        const std::uint32_t* keys = keyIds<T>(fields, seq);
+        (decodeField(node, out, trail, std::get<I>(fields), keys[I]), ...);
+    }
+
+    template <typename T, typename Class, typename Member>
+    void decodeField(std::uint32_t node, T& out, const Trail& trail, const Field<Class, Member>& f, std::uint32_t key) {
+        static_assert(std::is_base_of_v<Class, T>, "mstd::yaml::schema: field does not belong to this type");
+        std::uint32_t child = key == noKey ? noNode : doc_.find(node, key);
+        if (child == noNode) {
+            if constexpr (is_optional<Member>::value) {
+                (out.*f.member).reset();
+            } else if (f.required) {
+                throw std::runtime_error(Trail{&trail, f.name, 0}.where() + ": missing required field");
+            }
+            return;
+        }
+        decode(child, out.*f.member, Trail{&trail, f.name, 0});
+    }
+
+    // 类型 T 各字段的 key id, 按字段在 tuple 中的下标存放; 每个类型只查一次文档的 key 表,
+    // 同一个类型出现在数组里时直接按下标取, 不用重复计算字符串哈希
+    template <typename T, typename Fields, std::size_t... I>
+    const std::uint32_t* keyIds(const Fields& fields, std::index_sequence<I...>) {
+        std::size_t slot = schemaSlot<T>();
+        if (slot >= keyIds_.size()) keyIds_.resize(slot + 1);
+        std::vector<std::uint32_t>& ids = keyIds_[slot];
+        if (ids.size() != sizeof...(I)) ids = {doc_.keyId(std::get<I>(fields).name)...};
+        return ids.data();
+    }
+
+    const Document& doc_;
+    std::vector<std::vector<std::uint32_t>> keyIds_; // 按 schemaSlot 编号
+};
+
+}
+
+/// @brief 把 YamlReader 当前节点一次性解码到结构体中
+/// 类型检查在编译期根据成员类型展开, 运行时只比较节点类型标签
+/// @tparam T 需要特化 mstd::yaml::schema<T> 的结构体, 或者 vector / optional / map<std::string, U> / 基础类型
+/// @param reader 文档或者其中的某个对象
+/// @return 解码后的值
+template <typename T>
+T decode(const YamlReader& reader) {
+    T out{};
+    detail::Decoder decoder(*reader.document());
+    decoder.decode(reader.node(), out, detail::Trail{nullptr, mstd::string_view(), 0});
+    return out;
+}
+
+/// @brief 解码到已有的对象中, 可选字段缺失时保留原来的值
+template <typename T>
+void decode(const YamlReader& reader, T& out) {
+    detail::Decoder decoder(*reader.document());
+    decoder.decode(reader.node(), out, detail::Trail{nullptr, mstd::string_view(), 0});
+}
+
+}
+}
@@ -0,0 +1,96 @@
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test.hpp"
+#include "mstd/ConfigHandle.hpp"
+
+namespace {
+
+const char* config_path = "config_handle_test.yaml";
+
+void write_config(const std::string& text) {
+    std::ofstream(config_path, std::ios::binary | std::ios::trunc) << text;
+}
+
+std::string config_text(int generation) {
+    return "generation: " + std::to_string(generation) + "\nname: \"gen " + std::to_string(generation) + "\"\n";
+}
+
+}
+
+TEST(reload_publishes_new_snapshot) {
+    write_config(config_text(1));
+    mstd::ConfigHandle handle(config_path, std::chrono::milliseconds(0));
+    CHECK_EQ(handle.version(), 1u);
+    CHECK_EQ(handle.config().get<int>("generation"), 1);
+
+    auto held = handle.snapshot();
+    auto reader = handle.reader();
+    write_config(config_text(2));
+    CHECK(handle.reload());
+    CHECK_EQ(handle.version(), 2u);
+    CHECK(handle.lastError().empty());
+    // 旧快照在持有期间保持不变
+    CHECK_EQ(held->version, 1u);
+    CHECK_EQ(held->config.get<int>("generation"), 1);
+    CHECK_EQ(reader->get<int>("generation"), 2);
+    CHECK_EQ(reader.version(), 2u);
+    std::remove(config_path);
+}
+
+TEST(failed_reload_keeps_old_snapshot) {
+    write_config(config_text(1));
+    mstd::ConfigHandle handle(config_path, std::chrono::milliseconds(0));
+    write_config("- orphan item\n");
+    CHECK(!handle.reload());
+    CHECK(!handle.lastError().empty());
+    CHECK_EQ(handle.version(), 1u);
+    CHECK_EQ(handle.config().get<std::string>("name"), "gen 1");
+    std::remove(config_path);
+    CHECK(!handle.reload());
+    CHECK_EQ(handle.snapshot()->version, 1u);
+}
+
+// 读者不停地取快照, 写者同时反复发布; 每个快照的内容都要和它的版本一致, 同一个线程看到的版本不会倒退
+TEST(concurrent_readers_and_reloads) {
+    write_config(config_text(1));
+    mstd::ConfigHandle handle(config_path, std::chrono::milliseconds(0));
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            auto reader = handle.reader();
+            std::uint64_t last = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto snapshot = handle.snapshot();
+                const int generation = t % 2 ? snapshot->config.get<int>("generation") : reader->get<int>("generation");
+                const std::uint64_t version = t % 2 ? snapshot->version : reader.version();
+                if (static_cast<std::uint64_t>(generation) != version || version < last) ++errors;
+                last = version;
+            }
+        });
+    }
+    const int reloads = 300;
+    for (int i = 2; i <= reloads; ++i) {
+        write_config(config_text(i));
+        if (!handle.reload()) ++errors;
+    }
+    stop = true;
+    for (auto& reader : readers) reader.join();
+    CHECK_EQ(errors.load(), 0);
+    CHECK_EQ(handle.version(), static_cast<std::uint64_t>(reloads));
+    std::remove(config_path);
+}
+
+TEST(from_buffer_takes_ownership) {
+    std::string text = config_text(7);
+    auto reader = mstd::YamlReader::fromBuffer(std::move(text));
+    CHECK_EQ(reader.get<int>("generation"), 7);
+    CHECK_EQ(reader.get<std::string>("name"), "gen 7");
+}
+
+TEST_MAIN()
@@ -0,0 +1,173 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <string>
+#include "test.hpp"
+#include "mstd/FileCache.hpp"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+namespace {
+
+void write_file(const std::string& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+}
+
+std::string content_of(const std::optional<std::pair<std::shared_ptr<const std::vector<char>>, std::string>>& result) {
+    return result ? std::string(result->first->begin(), result->first->end()) : std::string("<none>");
+}
+
+}
+
+TEST(hit_miss_and_lru) {
+    write_file("fc_a.txt", "aaaa");
+    write_file("fc_b.html", "bbbb");
+    write_file("fc_c.bin", "cccc");
+    mstd::FileCache cache(10);
+    auto a = cache.get_shared("fc_a.txt");
+    CHECK_EQ(content_of(a), "aaaa");
+    CHECK_EQ(a->second, "text/plain; charset=utf-8");
+    CHECK_EQ(cache.get_shared("fc_b.html")->second, "text/html; charset=utf-8");
+    CHECK_EQ(cache.get_shared("fc_a.txt")->second, "text/plain; charset=utf-8");
+    CHECK_EQ(cache.get_cache_hits(), 1u);
+    CHECK_EQ(cache.get_cache_misses(), 2u);
+    // 超过 10 字节时淘汰最久未使用的 fc_b.html
+    CHECK_EQ(cache.get_shared("fc_c.bin")->second, "application/octet-stream");
+    cache.get_shared("fc_a.txt");
+    CHECK_EQ(cache.get_cache_hits(), 2u);
+    cache.get_shared("fc_b.html");
+    CHECK_EQ(cache.get_cache_misses(), 4u);
+    CHECK(!cache.get_shared("fc_missing.txt"));
+    // 已经返回的内容在淘汰后仍然有效
+    CHECK_EQ(content_of(a), "aaaa");
+    std::remove("fc_a.txt");
+    std::remove("fc_b.html");
+    std::remove("fc_c.bin");
+}
+
+#ifndef _WIN32
+// 修改时间倒退 (从备份恢复) 或者大小变化都视为已修改; 文件被删除时移除条目
+TEST(detects_changes_and_removal) {
+    write_file("fc_d.txt", "version-1");
+    mstd::FileCache cache;
+    CHECK_EQ(content_of(cache.get_shared("fc_d.txt")), "version-1");
+
+    struct stat before;
+    CHECK(stat("fc_d.txt", &before) == 0);
+    write_file("fc_d.txt", "version-2"); // 同样的大小
+    struct utimbuf older{before.st_atime - 100, before.st_mtime - 100};
+    CHECK(utime("fc_d.txt", &older) == 0);
+    CHECK_EQ(content_of(cache.get_shared("fc_d.txt")), "version-2");
+
+    // 大小变化但修改时间相同
+    write_file("fc_d.txt", "v3");
+    CHECK(utime("fc_d.txt", &older) == 0);
+    CHECK_EQ(content_of(cache.get_shared("fc_d.txt")), "v3");
+    CHECK_EQ(cache.get_cache_hits(), 0u);
+    CHECK_EQ(content_of(cache.get_shared("fc_d.txt")), "v3");
+    CHECK_EQ(cache.get_cache_hits(), 1u);
+
+    std::remove("fc_d.txt");
+    CHECK(!cache.get_shared("fc_d.txt"));
+    // 条目已经被移除, 文件重新出现后按未命中重新加载
+    write_file("fc_d.txt", "back");
+    CHECK_EQ(content_of(cache.get_shared("fc_d.txt")), "back");
+    CHECK_EQ(cache.get_cache_hits(), 1u);
+    std::remove("fc_d.txt");
+}
+#endif
+
+TEST(snapshot_roundtrip) {
+    write_file("fc_s1.txt", "first file");
+    write_file("fc_s2.css", "body{}");
+    write_file("fc_s3.js", std::string(1000, 'x'));
+    {
+        mstd::FileCache cache;
+        cache.get_shared("fc_s3.js");
+        cache.get_shared("fc_s2.css");
+        cache.get_shared("fc_s1.txt"); // 最近使用的在前: s1, s2, s3
+        CHECK(cache.save_snapshot("fc.snapshot"));
+    }
+
+    mstd::FileCache restored;
+    CHECK_EQ(restored.load_snapshot("fc.snapshot"), 3u);
+    CHECK_EQ(restored.load_snapshot("fc.snapshot"), 0u); // 已经在缓存中的条目保持不变
+    auto s2 = restored.get_shared("fc_s2.css");
+    CHECK_EQ(content_of(s2), "body{}");
+    CHECK_EQ(s2->second, "text/css; charset=utf-8");
+    CHECK_EQ(content_of(restored.get_shared("fc_s3.js")), std::string(1000, 'x'));
+    CHECK_EQ(restored.get_cache_hits(), 2u);
+    CHECK_EQ(restored.get_cache_misses(), 0u);
+
+    // 快照之后源文件变了: 命中时发现并重新加载
+    write_file("fc_s1.txt", "first file, edited");
+    CHECK_EQ(content_of(restored.get_shared("fc_s1.txt")), "first file, edited");
+    CHECK_EQ(restored.get_cache_misses(), 1u);
+
+    // 容量不够时只恢复最近使用的部分
+    mstd::FileCache small(20);
+    CHECK_EQ(small.load_snapshot("fc.snapshot"), 2u);
+
+    // 再次保存恢复出来 (还没有读出内容) 的条目
+    mstd::FileCache again;
+    again.load_snapshot("fc.snapshot");
+    CHECK(again.save_snapshot("fc2.snapshot"));
+    mstd::FileCache third;
+    CHECK_EQ(third.load_snapshot("fc2.snapshot"), 3u);
+    CHECK_EQ(content_of(third.get_shared("fc_s2.css")), "body{}");
+
+    std::remove("fc_s1.txt");
+    std::remove("fc_s2.css");
+    std::remove("fc_s3.js");
+    std::remove("fc2.snapshot");
+}
+
+TEST(corrupt_snapshots_are_rejected) {
+    mstd::FileCache cache;
+    CHECK_EQ(cache.load_snapshot("fc_no_such.snapshot"), 0u);
+    write_file("fc_bad.snapshot", "not a snapshot at all, just some text that is long enough to hold a header");
+    CHECK_EQ(cache.load_snapshot("fc_bad.snapshot"), 0u);
+    // 截断的快照
+    std::ifstream in("fc.snapshot", std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    write_file("fc_bad.snapshot", bytes.substr(0, bytes.size() - 1));
+    CHECK_EQ(cache.load_snapshot("fc_bad.snapshot"), 0u);
+    std::remove("fc_bad.snapshot");
+    std::remove("fc.snapshot");
+}
+
+#ifndef _WIN32
+// 读盘不持有锁: 一个线程卡在打开 FIFO 上时, 其他文件的加载和命中照常进行
+TEST(slow_load_does_not_block_other_files) {
+    const char* fifo = "fc_slow.fifo";
+    std::remove(fifo);
+    CHECK(mkfifo(fifo, 0600) == 0);
+    write_file("fc_fast.txt", "fast");
+    mstd::FileCache cache;
+    auto slow = std::async(std::launch::async, [&] { return cache.get_shared(fifo); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // 让 slow 先进入 load_file
+    auto fast = std::async(std::launch::async, [&] {
+        cache.get_shared("fc_fast.txt");
+        return cache.get_shared("fc_fast.txt");
+    });
+    const bool finished = fast.wait_for(std::chrono::seconds(3)) == std::future_status::ready;
+    CHECK(finished);
+    // 打开写端, 让卡住的读取返回 (FIFO 没有大小, 加载失败); 非阻塞打开, 读端不在时不会卡住测试
+    int fd = ::open(fifo, O_WRONLY | O_NONBLOCK);
+    CHECK(fd >= 0);
+    if (fd >= 0) ::close(fd);
+    CHECK(!slow.get());
+    CHECK_EQ(content_of(fast.get()), "fast");
+    CHECK_EQ(cache.get_cache_hits(), 1u);
+    std::remove(fifo);
+    std::remove("fc_fast.txt");
+}
+#endif
+
+TEST_MAIN()
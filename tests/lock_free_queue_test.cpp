@@ -0,0 +1,78 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test.hpp"
+#include "mstd/LockFreeQueue.hpp"
+
+TEST(fifo_single_thread) {
+    mstd::LockFreeQueue<int> queue;
+    CHECK(queue.empty());
+    CHECK(!queue.dequeue());
+    for (int i = 0; i < 1000; ++i) queue.enqueue(i);
+    CHECK(!queue.empty());
+    for (int i = 0; i < 1000; ++i) {
+        auto value = queue.dequeue();
+        CHECK(value && *value == i);
+    }
+    CHECK(queue.empty());
+    CHECK(!queue.dequeue());
+}
+
+// 不要求 T 可以默认构造; 析构时释放还在队列中的元素 (配合 ASan 检查)
+TEST(non_default_constructible) {
+    struct Item {
+        explicit Item(std::string s) : text(std::move(s)) {}
+        std::string text;
+    };
+    mstd::LockFreeQueue<Item> queue;
+    queue.enqueue(Item("a"));
+    queue.enqueue(Item(std::string(100, 'b')));
+    CHECK(queue.dequeue()->text == "a");
+}
+
+// 4 个生产者、4 个消费者, 共 80 万个元素: 每个元素恰好取出一次, 同一生产者的元素保持顺序
+TEST(mpmc_stress) {
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr std::uint64_t per_producer = 200000;
+    mstd::LockFreeQueue<std::uint64_t> queue;
+    std::vector<std::atomic<std::uint8_t>> seen(producers * per_producer);
+    std::atomic<std::uint64_t> consumed{0};
+    std::atomic<int> order_errors{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (std::uint64_t i = 0; i < per_producer; ++i) queue.enqueue(p * per_producer + i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            std::vector<std::uint64_t> last(producers, 0);
+            std::vector<bool> any(producers, false);
+            while (consumed.load() < producers * per_producer) {
+                auto value = queue.dequeue();
+                if (!value) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::uint64_t p = *value / per_producer;
+                if (any[p] && *value <= last[p]) ++order_errors;
+                any[p] = true;
+                last[p] = *value;
+                seen[*value].fetch_add(1);
+                consumed.fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    CHECK(queue.empty());
+    CHECK_EQ(order_errors.load(), 0);
+    std::uint64_t wrong = 0;
+    for (auto& count : seen) wrong += count.load() != 1;
+    CHECK_EQ(wrong, 0u);
+}
+
+TEST_MAIN()
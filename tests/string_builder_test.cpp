@@ -0,0 +1,111 @@
+#include <string>
+#include <vector>
+#include "test.hpp"
+#include "mstd/string_builder.hpp"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+TEST(append_formats_values) {
+    mstd::string_builder b;
+    b << "n=" << 42 << ' ' << -7LL << ' ' << true << ' ' << 1.5 << mstd::string_view("!");
+    CHECK_EQ(b.str(), std::string("n=42 -7 true 1.5!"));
+    CHECK_EQ(b.size(), b.str().size());
+    CHECK(b.to_string() == "n=42 -7 true 1.5!");
+    b.clear();
+    CHECK(b.empty());
+    b << "again";
+    CHECK_EQ(b.str(), std::string("again"));
+}
+
+// 每种浮点类型按自己的最短表示输出
+TEST(append_floating_point_types) {
+    mstd::string_builder b;
+    b << 0.1f << ' ' << 0.1 << ' ' << -2.5L << ' ';
+    b.append(static_cast<long double>(0.25));
+    CHECK_EQ(b.str(), std::string("0.1 0.1 -2.5 0.25"));
+}
+
+// 大量追加跨越多个内存块, 内容顺序不变
+TEST(large_appends_span_chunks) {
+    mstd::string_builder b;
+    std::string expected;
+    for (int i = 0; i < 20000; ++i) {
+        b << i << ',';
+        expected += std::to_string(i) + ',';
+    }
+    std::string big(100000, 'x');
+    b.append(big);
+    expected += big;
+    CHECK(b.str() == expected);
+}
+
+TEST(append_ref_keeps_body_alive) {
+    auto body = std::make_shared<const std::vector<char>>(std::vector<char>{'a', 'b', 'c'});
+    mstd::string_builder b;
+    b << "head:";
+    b.append_ref(body);
+    body.reset();
+    b << ":tail";
+    CHECK_EQ(b.str(), std::string("head:abc:tail"));
+}
+
+TEST(string_append_grows) {
+    mstd::string s;
+    for (int i = 0; i < 1000; ++i) s += "ab";
+    CHECK_EQ(s.size(), 2000u);
+    CHECK(s.view().substr(1998) == "ab");
+}
+
+#ifndef _WIN32
+// 非阻塞管道写满后返回已写出的字节数和 EAGAIN, 从该位置继续可以写完剩余数据
+TEST(write_to_resumes_after_eagain) {
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    ::fcntl(fds[1], F_SETFL, ::fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    mstd::string_builder b;
+    std::string expected;
+    for (int i = 0; i < 100000; ++i) {
+        b << i << '\n';
+        expected += std::to_string(i) + '\n';
+    }
+    std::string big(300000, 'z');
+    b.append_ref(mstd::string_view(big.data(), big.size()));
+    expected += big;
+
+    std::string received;
+    std::size_t sent = 0;
+    int stalls = 0;
+    for (;;) {
+        auto result = b.write_to(fds[1], sent);
+        sent += result.written;
+        if (result.complete()) break;
+        CHECK(result.error == EAGAIN || result.error == EWOULDBLOCK);
+        ++stalls;
+        char buf[65536];
+        ssize_t n = ::read(fds[0], buf, sizeof(buf));
+        if (n > 0) received.append(buf, static_cast<size_t>(n));
+    }
+    CHECK(stalls > 0);
+    CHECK_EQ(sent, expected.size());
+    ::close(fds[1]);
+    char buf[65536];
+    ssize_t n;
+    while ((n = ::read(fds[0], buf, sizeof(buf))) > 0) received.append(buf, static_cast<size_t>(n));
+    ::close(fds[0]);
+    CHECK(received == expected);
+}
+
+TEST(write_to_reports_errors) {
+    mstd::string_builder b;
+    b << "data";
+    auto result = b.write_to(-1);
+    CHECK_EQ(result.written, 0u);
+    CHECK_EQ(result.error, EBADF);
+    CHECK(b.write_to(-1, 4).complete()); // 没有剩余数据
+}
+#endif
+
+TEST_MAIN()
@@ -0,0 +1,87 @@
+#include <random>
+#include <string>
+#include "test.hpp"
+#include "mstd/string.hpp"
+
+namespace {
+
+// 各种长度和起始偏移, 覆盖 SIMD 主循环和标量尾部
+std::string random_text(std::mt19937& rng, size_t n) {
+    std::string s(n, 'a');
+    for (char& c : s) c = static_cast<char>("abcAB\x80z"[rng() % 7]);
+    return s;
+}
+
+size_t naive_find(const std::string& h, const std::string& nd) {
+    return h.find(nd);
+}
+
+}
+
+TEST(kernels_match_std) {
+    std::mt19937 rng(42);
+    for (size_t n = 0; n < 200; ++n) {
+        std::string text = random_text(rng, n);
+        for (size_t nn = 0; nn <= 5 && nn <= n + 1; ++nn) {
+            std::string needle = nn <= n ? text.substr(rng() % (n - nn + 1), nn) : random_text(rng, nn);
+            if (rng() % 2 && nn) needle[nn - 1] = 'q'; // 也测试找不到的情况
+            CHECK_EQ(mstd::simd::find(text.data(), n, needle.data(), nn), naive_find(text, needle));
+            CHECK_EQ(mstd::simd::rfind(text.data(), n, needle.data(), nn), text.rfind(needle));
+#ifdef MSTD_SIMD_X86
+            CHECK_EQ(mstd::simd::sse2::find(text.data(), n, needle.data(), nn), naive_find(text, needle));
+            if (__builtin_cpu_supports("avx2")) {
+                CHECK_EQ(mstd::simd::avx2::find(text.data(), n, needle.data(), nn), naive_find(text, needle));
+            }
+#endif
+        }
+        for (char c : {'a', 'z', 'q', '\x80'}) {
+            CHECK_EQ(mstd::simd::find_char(text.data(), n, c), text.find(c));
+            CHECK_EQ(mstd::simd::rfind_char(text.data(), n, c), text.rfind(c));
+        }
+        CHECK_EQ(mstd::simd::find_first_of(text.data(), n, "zB", 2), text.find_first_of("zB"));
+        CHECK_EQ(mstd::simd::find_first_not_of(text.data(), n, "abc", 3), text.find_first_not_of("abc"));
+
+        std::string other = text;
+        if (n) other[rng() % n] ^= 0x20; // 可能只改了大小写
+        size_t diff = std::mismatch(text.begin(), text.end(), other.begin()).first - text.begin();
+        CHECK_EQ(mstd::simd::mismatch(text.data(), other.data(), n), diff);
+        int expected = text.compare(other);
+        int actual = mstd::simd::compare(text.data(), n, other.data(), n);
+        CHECK((expected < 0) == (actual < 0) && (expected > 0) == (actual > 0));
+    }
+}
+
+TEST(case_insensitive) {
+    mstd::string s("Content-Type");
+    CHECK(s.iequals("content-type"));
+    CHECK(!s.iequals("content-typo"));
+    CHECK(s.icompare("CONTENT-TYPE") == 0);
+    CHECK(s.icompare("content-u") < 0);
+    CHECK(mstd::string_view("\x80" "A").iequals("\x80" "a"));
+    CHECK(!mstd::string_view("\xC0").iequals("\xE0")); // 只折叠 ASCII
+}
+
+TEST(find_overloads) {
+    mstd::string s("abcxabcx");
+    CHECK_EQ(s.find('x'), 3u);
+    CHECK_EQ(s.find('x', 4), 7u);
+    CHECK_EQ(s.find("x", 4), 7u);
+    CHECK_EQ(s.find("abcz", 1, 3), 4u); // (子串, 起始位置, 长度), 与 std::string 相同
+    CHECK_EQ(s.rfind("x", 6), 3u);
+    CHECK_EQ(s.rfind("abcz", 7, 3), 4u);
+    CHECK_EQ(s.find("abc", 5), mstd::string::npos);
+    CHECK_EQ(s.find("", 8), 8u);
+    CHECK_EQ(s.find('a', 100), mstd::string::npos);
+    CHECK_EQ(s.find_first_of("cx", 3), 3u);
+    CHECK_EQ(s.find_last_not_of("x"), 6u);
+}
+
+TEST(hash_matches_content) {
+    mstd::string a("hello world, this is longer than sixteen bytes");
+    mstd::string b(a);
+    CHECK_EQ(a.view().hash(), b.view().hash());
+    CHECK(a.view().hash() != a.view(1).hash());
+    CHECK_EQ(std::hash<mstd::string_view>()(a.view(0, 5)), mstd::string_view("hello").hash());
+}
+
+TEST_MAIN()
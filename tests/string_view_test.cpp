@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "test.hpp"
+#include "mstd/string.hpp"
+
+namespace {
+
+template <typename Range>
+std::vector<std::string> collect(const Range& range) {
+    std::vector<std::string> out;
+    for (mstd::string_view part : range) out.push_back(part.to_std_string());
+    return out;
+}
+
+using parts = std::vector<std::string>;
+
+}
+
+TEST(split_keeps_empty_fields) {
+    CHECK(collect(mstd::string_view("a,,b").split(',')) == (parts{"a", "", "b"}));
+    CHECK(collect(mstd::string_view(",a,").split(',')) == (parts{"", "a", ""}));
+    CHECK(collect(mstd::string_view("abc").split(',')) == (parts{"abc"}));
+    CHECK(collect(mstd::string_view("").split(',')) == (parts{""}));
+}
+
+TEST(tokenize_skips_empty_fields) {
+    CHECK(collect(mstd::string_view("  a  b ").tokenize()) == (parts{"a", "b"}));
+    CHECK(collect(mstd::string_view("a\tb\r\nc").tokenize()) == (parts{"a", "b", "c"}));
+    CHECK(collect(mstd::string_view("k=v;;x=y").tokenize(";=")) == (parts{"k", "v", "x", "y"}));
+    CHECK(collect(mstd::string_view("   ").tokenize()).empty());
+}
+
+// 切分结果指向原始数据, 不复制
+TEST(split_views_point_into_source) {
+    const char* text = "GET /index.html HTTP/1.1";
+    mstd::string_view view(text);
+    std::vector<mstd::string_view> fields;
+    for (mstd::string_view part : view.split(' ')) fields.push_back(part);
+    CHECK_EQ(fields.size(), 3u);
+    CHECK(fields[1].data() == text + 4);
+    CHECK(fields[1] == "/index.html");
+}
+
+// 切分区间可以直接交给标准库算法
+TEST(split_range_works_with_std_algorithms) {
+    auto fields = mstd::string_view("a,bb,,ccc").split(',');
+    CHECK_EQ(std::distance(fields.begin(), fields.end()), 4);
+    std::vector<mstd::string_view> copy(fields.begin(), fields.end());
+    CHECK(copy.size() == 4u && copy[3] == "ccc");
+    CHECK(std::count_if(fields.begin(), fields.end(), [](mstd::string_view f) { return f.empty(); }) == 1);
+    auto it = std::find(fields.begin(), fields.end(), mstd::string_view("bb"));
+    CHECK(it != fields.end() && it->data() == copy[1].data());
+    auto tokens = mstd::string_view(" x  y ").tokenize();
+    CHECK_EQ(std::distance(tokens.begin(), tokens.end()), 2);
+    static_assert(std::is_same<std::iterator_traits<decltype(fields.begin())>::iterator_category,
+                               std::forward_iterator_tag>::value, "split_range::iterator is a forward iterator");
+}
+
+TEST(trim_substr_and_prefixes) {
+    mstd::string_view v("  hello world \n");
+    CHECK(v.trim() == "hello world");
+    CHECK(mstd::string_view(" \t ").trim().empty());
+    mstd::string_view t = v.trim();
+    CHECK(t.starts_with("hello") && t.ends_with('d') && !t.ends_with("hello"));
+    CHECK(t.substr(6) == "world");
+    CHECK(t.substr(6, 100) == "world");
+}
+
+TEST(comparisons_and_conversions) {
+    mstd::string owned("beta");
+    CHECK(owned.view() == "beta");
+    CHECK(mstd::string_view("alpha") < owned.view());
+    CHECK(mstd::string_view("b") < mstd::string_view("ba"));
+    CHECK(std::string(mstd::string_view("xyz")) == "xyz");
+    std::string_view sv = mstd::string_view("std");
+    CHECK(sv == "std");
+
+    std::unordered_map<mstd::string_view, int> map;
+    map[mstd::string_view("key")] = 1;
+    std::string key = "key";
+    CHECK(map.count(mstd::string_view(key.data(), key.size())) == 1);
+}
+
+TEST_MAIN()
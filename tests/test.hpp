@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 最小的测试框架: 每个 tests/*_test.cpp 编译为一个程序, 由 ctest 运行
+// TEST(name) { CHECK(...); } 定义测试, 文件末尾用 TEST_MAIN() 生成 main
+
+namespace test {
+
+struct Case {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<Case>& cases() {
+    static std::vector<Case> all;
+    return all;
+}
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+struct Register {
+    Register(const char* name, void (*run)()) {
+        cases().push_back(Case{name, run});
+    }
+};
+
+inline void fail(const char* file, int line, const std::string& message) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, message.c_str());
+    ++failures();
+}
+
+/// @brief 依次运行所有测试, 返回失败的检查数 (作为进程退出码)
+inline int run_all() {
+    for (const Case& c : cases()) {
+        int before = failures();
+        try {
+            c.run();
+        } catch (const std::exception& e) {
+            fail(c.name, 0, std::string("unexpected exception: ") + e.what());
+        }
+        std::fprintf(stderr, "[%s] %s\n", failures() == before ? "  OK  " : "FAILED", c.name);
+    }
+    return failures() == 0 ? 0 : 1;
+}
+
+}
+
+#define TEST(name)                                                   \
+    static void name();                                              \
+    static ::test::Register name##_register(#name, name);            \
+    static void name()
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) ::test::fail(__FILE__, __LINE__, #cond);        \
+    } while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+#define CHECK_THROWS(expr)                                           \
+    do {                                                             \
+        bool threw_ = false;                                         \
+        try {                                                        \
+            (void)(expr);                                            \
+        } catch (...) {                                              \
+            threw_ = true;                                           \
+        }                                                            \
+        if (!threw_) ::test::fail(__FILE__, __LINE__, "expected exception: " #expr); \
+    } while (0)
+
+#define TEST_MAIN()                                                  \
+    int main() {                                                     \
+        return ::test::run_all();                                    \
+    }
@@ -0,0 +1,160 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "test.hpp"
+#include "mstd/ThreadPool.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+// 轮询等待条件成立, 超时返回 false; 机器很慢时也不会误报
+template <typename Pred>
+bool wait_until(Pred pred, milliseconds timeout = milliseconds(5000)) {
+    const auto deadline = Clock::now() + timeout;
+    while (!pred()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+}
+
+TEST(enqueue_returns_result) {
+    mstd::ThreadPool pool(2);
+    auto a = pool.enqueue([](int x, int y) { return x + y; }, 2, 3);
+    auto b = pool.enqueue([] { throw std::runtime_error("boom"); });
+    CHECK_EQ(a.get(), 5);
+    CHECK_THROWS(b.get());
+}
+
+TEST(schedule_after_never_fires_early) {
+    mstd::ThreadPool pool(1);
+    const auto start = Clock::now();
+    std::atomic<long long> elapsed{-1};
+    pool.schedule_after(milliseconds(30), [&] {
+        elapsed = std::chrono::duration_cast<milliseconds>(Clock::now() - start).count();
+    });
+    CHECK(wait_until([&] { return elapsed.load() >= 0; }));
+    CHECK(elapsed.load() >= 30);
+}
+
+TEST(cancelled_timer_does_not_run) {
+    mstd::ThreadPool pool(1);
+    std::atomic<int> runs{0};
+    auto id = pool.schedule_after(milliseconds(50), [&] { ++runs; });
+    CHECK(pool.cancel(id));
+    CHECK(!pool.cancel(id));
+    std::atomic<bool> later{false};
+    pool.schedule_after(milliseconds(80), [&] { later = true; });
+    CHECK(wait_until([&] { return later.load(); }));
+    CHECK_EQ(runs.load(), 0);
+}
+
+TEST(schedule_every_repeats_until_cancelled) {
+    mstd::ThreadPool pool(2);
+    std::atomic<int> runs{0};
+    auto id = pool.schedule_every(milliseconds(5), [&] { ++runs; });
+    CHECK(wait_until([&] { return runs.load() >= 3; }));
+    CHECK(pool.cancel(id));
+    // 已经进入队列的那一次仍会执行, 之后不再增加
+    std::this_thread::sleep_for(milliseconds(30));
+    const int settled = runs.load();
+    std::this_thread::sleep_for(milliseconds(30));
+    CHECK_EQ(runs.load(), settled);
+}
+
+// 周期任务上一次还没结束时跳过本次, 不会并发执行
+TEST(periodic_task_never_overlaps) {
+    mstd::ThreadPool pool(4);
+    std::atomic<int> active{0};
+    std::atomic<int> overlaps{0};
+    std::atomic<int> runs{0};
+    auto id = pool.schedule_every(milliseconds(1), [&] {
+        if (active.fetch_add(1) != 0) ++overlaps;
+        std::this_thread::sleep_for(milliseconds(5));
+        active.fetch_sub(1);
+        ++runs;
+    });
+    CHECK(wait_until([&] { return runs.load() >= 5; }));
+    pool.cancel(id);
+    CHECK_EQ(overlaps.load(), 0);
+}
+
+TEST(throwing_timer_task_keeps_pool_alive) {
+    mstd::ThreadPool pool(1);
+    pool.schedule_after(milliseconds(1), [] { throw std::runtime_error("scheduled failure (expected)"); });
+    std::atomic<bool> ran{false};
+    pool.schedule_after(milliseconds(10), [&] { ran = true; });
+    CHECK(wait_until([&] { return ran.load(); }));
+    CHECK_EQ(pool.enqueue([] { return 7; }).get(), 7);
+}
+
+TEST(destructor_with_pending_timers) {
+    std::atomic<int> runs{0};
+    {
+        mstd::ThreadPool pool(1);
+        pool.schedule_after(std::chrono::hours(1), [&] { ++runs; });
+        pool.schedule_every(std::chrono::seconds(10), [&] { ++runs; });
+    }
+    CHECK_EQ(runs.load(), 0);
+}
+
+// 唯一的线程被长任务占住时, 1ms 内一次性提交的任务不会再触发入队/出队, 由计时线程发现积压并增加线程
+TEST(burst_behind_busy_worker_grows_pool) {
+    mstd::ThreadPool pool(1, 4);
+    std::atomic<int> done{0};
+    std::atomic<bool> started{false};
+    auto blocker = pool.enqueue([&] {
+        started = true;
+        // 积压的任务跑完才结束; 线程池没有增长时等到超时
+        return wait_until([&] { return done.load() == 8; }, milliseconds(3000));
+    });
+    CHECK(wait_until([&] { return started.load(); }));
+    for (int i = 0; i < 8; ++i) pool.enqueue([&] { ++done; });
+    CHECK(blocker.get());
+    CHECK(pool.thread_count() > 1);
+}
+
+// 所有线程都在 blocking_section 中时, 补充的线程继续处理队列
+TEST(blocking_section_spawns_replacement) {
+    mstd::ThreadPool pool(2, 2);
+    std::atomic<bool> release{false};
+    std::atomic<int> blocked{0};
+    std::vector<std::future<void>> blockers;
+    for (int i = 0; i < 2; ++i) {
+        blockers.push_back(pool.enqueue([&] {
+            mstd::blocking_section section;
+            ++blocked;
+            wait_until([&] { return release.load(); });
+        }));
+    }
+    CHECK(wait_until([&] { return blocked.load() == 2; }));
+    auto other = pool.enqueue([] { return 42; });
+    CHECK(other.wait_for(std::chrono::seconds(3)) == std::future_status::ready);
+    CHECK(pool.thread_count() >= 3);
+    release = true;
+    for (auto& b : blockers) b.get();
+    CHECK_EQ(other.get(), 42);
+    // 被阻塞的线程回来后, 补充的线程退出
+    CHECK(wait_until([&] { return pool.thread_count() == 2; }));
+}
+
+TEST(idle_threads_shrink_back) {
+    mstd::ThreadPool pool(1, 4, milliseconds(20));
+    std::atomic<bool> release{false};
+    std::vector<std::future<void>> tasks;
+    for (int i = 0; i < 4; ++i) {
+        tasks.push_back(pool.enqueue([&] { wait_until([&] { return release.load(); }); }));
+    }
+    CHECK(wait_until([&] { return pool.thread_count() == 4; }));
+    release = true;
+    for (auto& t : tasks) t.get();
+    CHECK(wait_until([&] { return pool.thread_count() == 1; }));
+}
+
+TEST_MAIN()
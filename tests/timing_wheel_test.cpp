@@ -0,0 +1,213 @@
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+#include "test.hpp"
+#include "mstd/TimingWheel.hpp"
+
+namespace {
+
+using Wheel = mstd::TimingWheel;
+
+// 记录每次触发的 (编号, tick)
+struct Log {
+    std::vector<std::pair<int, std::uint64_t>> fired;
+    std::uint64_t tick = 0;
+};
+
+Wheel::Task make_task(Log& log, int id) {
+    return std::make_shared<mstd::Function<void()>>([&log, id] { log.fired.emplace_back(id, log.tick); });
+}
+
+void advance_to(Wheel& wheel, Log& log, std::uint64_t tick) {
+    while (wheel.now() <= tick) {
+        log.tick = wheel.now();
+        wheel.advance(wheel.now(), [](const Wheel::Task& task) { (*task)(); });
+    }
+}
+
+}
+
+TEST(fires_at_exact_tick) {
+    Wheel wheel(100);
+    Log log;
+    wheel.add(100, make_task(log, 1));
+    wheel.add(50, make_task(log, 2)); // 已经过期, 下一次 advance 时触发
+    wheel.add(355, make_task(log, 3)); // 需要从第 1 层下放
+    wheel.add(100 + 70000, make_task(log, 4)); // 第 2 层
+    CHECK_EQ(wheel.size(), 4u);
+    advance_to(wheel, log, 100 + 80000);
+    CHECK(log.fired.size() == 4u);
+    std::map<int, std::uint64_t> at(log.fired.begin(), log.fired.end());
+    CHECK_EQ(at[1], 100u);
+    CHECK_EQ(at[2], 100u);
+    CHECK_EQ(at[3], 355u);
+    CHECK_EQ(at[4], 70100u);
+    CHECK(wheel.empty());
+}
+
+TEST(cancel_and_stale_ids) {
+    Wheel wheel;
+    Log log;
+    Wheel::TimerId a = wheel.add(10, make_task(log, 1));
+    CHECK(wheel.cancel(a));
+    CHECK(!wheel.cancel(a));
+    CHECK(!wheel.cancel(Wheel::invalidTimer));
+    // 节点被复用后旧编号仍然无效
+    Wheel::TimerId b = wheel.add(10, make_task(log, 2));
+    CHECK(a != b);
+    CHECK(!wheel.cancel(a));
+    advance_to(wheel, log, 20);
+    CHECK(log.fired.size() == 1u && log.fired[0].first == 2);
+    CHECK(!wheel.cancel(b)); // 已经触发
+}
+
+TEST(periodic_timers) {
+    Wheel wheel;
+    Log log;
+    Wheel::TimerId id = wheel.add(5, make_task(log, 1), 100);
+    advance_to(wheel, log, 400);
+    CHECK(log.fired.size() == 4u);
+    for (std::size_t i = 0; i < log.fired.size(); ++i) CHECK_EQ(log.fired[i].second, 5 + 100 * i);
+    CHECK_EQ(wheel.size(), 1u);
+    CHECK(wheel.cancel(id));
+    advance_to(wheel, log, 1000);
+    CHECK(log.fired.size() == 4u);
+}
+
+TEST(ticks_until_next) {
+    Wheel wheel;
+    Log log;
+    CHECK_EQ(wheel.ticksUntilNext(), UINT64_MAX);
+    wheel.add(40, make_task(log, 1));
+    CHECK_EQ(wheel.ticksUntilNext(), 40u);
+    wheel.add(5000, make_task(log, 2));
+    // 只推进 ticksUntilNext 给出的距离, 之前不会漏掉任何定时器
+    std::uint64_t guard = 0;
+    while (!wheel.empty() && ++guard < 1000) {
+        std::uint64_t wait = wheel.ticksUntilNext();
+        log.tick = wheel.now() + wait;
+        wheel.advance(wheel.now() + wait, [](const Wheel::Task& task) { (*task)(); });
+    }
+    CHECK(log.fired.size() == 2u);
+    CHECK_EQ(log.fired[0].second, 40u);
+    CHECK_EQ(log.fired[1].second, 5000u);
+}
+
+// 与按到期时间排序的参考实现对比: 随机添加和取消, 跨越多层
+TEST(randomized_against_reference) {
+    std::mt19937_64 rng(7);
+    Wheel wheel;
+    Log log;
+    std::map<int, std::uint64_t> expected; // 编号 -> 到期 tick
+    std::map<int, Wheel::TimerId> ids;
+    int next = 0;
+    const std::uint64_t end = 1u << 20;
+    std::uint64_t now = 0;
+    while (now < end) {
+        for (int k = 0; k < 4; ++k) {
+            std::uint64_t range = (rng() % 3 == 0) ? 300 : (rng() % 2 ? 20000 : end / 2);
+            std::uint64_t expires = now + rng() % range;
+            ids[next] = wheel.add(expires, make_task(log, next));
+            expected[next] = expires;
+            ++next;
+        }
+        if (!ids.empty() && rng() % 3 == 0) {
+            auto it = ids.lower_bound(static_cast<int>(rng() % static_cast<std::uint64_t>(next)));
+            if (it != ids.end()) {
+                // 已经触发的定时器都从 ids 中删掉了, 剩下的一定还在等待
+                CHECK(wheel.cancel(it->second));
+                expected.erase(it->first);
+                ids.erase(it);
+            }
+        }
+        const std::uint64_t target = std::min(end, now + rng() % 2000);
+        advance_to(wheel, log, target);
+        now = target + 1;
+        for (auto& f : log.fired) {
+            auto it = expected.find(f.first);
+            CHECK(it != expected.end());
+            if (it == expected.end()) continue;
+            CHECK_EQ(f.second, it->second);
+            expected.erase(it);
+            ids.erase(f.first);
+        }
+        log.fired.clear();
+    }
+    // 剩下的都还没有到期
+    for (auto& e : expected) CHECK(e.second >= now);
+    CHECK_EQ(wheel.size(), expected.size());
+}
+
+// 长时间没有推进之后追赶: 只处理有定时器到期或者需要下放的 tick, 与经过的 tick 数无关
+TEST(idle_gap_catch_up) {
+    using Clock = std::chrono::steady_clock;
+    const std::uint64_t day = 24ull * 3600 * 1000;
+    Wheel wheel;
+    Log log;
+    const auto start = Clock::now();
+    // 为空时直接跳过
+    wheel.advance(365 * day, [](const Wheel::Task&) {});
+    CHECK_EQ(wheel.now(), 365 * day + 1);
+
+    // 时间轮长期没有推进, 之后添加的定时器离 now() 很远 (第 4 层, 以及超出时间轮范围的)
+    Wheel stale;
+    const std::uint64_t a = 40 * day + 7;
+    const std::uint64_t b = 100 * day + 3;
+    stale.add(a, make_task(log, 1));
+    stale.add(b, make_task(log, 2));
+    stale.advance(a - 1, [](const Wheel::Task& task) { (*task)(); });
+    CHECK(log.fired.empty());
+    CHECK_EQ(stale.ticksUntilNext(), 0u); // 已经下放到第 0 层, 下一个 tick 就到期
+    log.tick = a;
+    stale.advance(a, [](const Wheel::Task& task) { (*task)(); });
+    CHECK(log.fired.size() == 1u && log.fired[0].first == 1);
+    stale.advance(b - 1, [](const Wheel::Task& task) { (*task)(); });
+    CHECK_EQ(log.fired.size(), 1u);
+    log.tick = b;
+    stale.advance(b, [](const Wheel::Task& task) { (*task)(); });
+    CHECK(log.fired.size() == 2u && log.fired[1].first == 2);
+    CHECK(stale.empty());
+    // 逐 tick 推进需要处理近百亿个 tick
+    CHECK(Clock::now() - start < std::chrono::milliseconds(200));
+}
+
+// 按 ticksUntilNext 大步推进, 与参考实现对比: 每个定时器都在到期的 tick 触发, 不会提前
+TEST(large_jumps_against_reference) {
+    std::mt19937_64 rng(11);
+    Wheel wheel(12345);
+    Log log;
+    std::map<int, std::uint64_t> expected;
+    int next = 0;
+    for (int round = 0; round < 200; ++round) {
+        for (int k = 0; k < 8; ++k) {
+            std::uint64_t range = (rng() % 2) ? 1000 : (rng() % 2 ? (1ull << 24) : (1ull << 34));
+            std::uint64_t expires = wheel.now() + rng() % range;
+            wheel.add(expires, make_task(log, next));
+            expected[next++] = expires;
+        }
+        const std::uint64_t target = wheel.now() + rng() % (1ull << 30);
+        int steps = 0;
+        while (wheel.now() <= target) {
+            std::uint64_t wait = wheel.ticksUntilNext();
+            std::uint64_t step = wait > target - wheel.now() ? target : wheel.now() + wait;
+            log.tick = step;
+            wheel.advance(step, [](const Wheel::Task& task) { (*task)(); });
+            ++steps;
+        }
+        CHECK(steps < 20000);
+        for (auto& f : log.fired) {
+            auto it = expected.find(f.first);
+            CHECK(it != expected.end());
+            if (it == expected.end()) continue;
+            CHECK_EQ(f.second, it->second);
+            expected.erase(it);
+        }
+        log.fired.clear();
+        for (auto& e : expected) CHECK(e.second > target);
+    }
+    CHECK_EQ(wheel.size(), expected.size());
+}
+
+TEST_MAIN()
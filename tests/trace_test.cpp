@@ -0,0 +1,86 @@
+#ifndef MSTD_TRACE
+#define MSTD_TRACE
+#endif
+#include <atomic>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test.hpp"
+#include "mstd/trace.hpp"
+
+namespace {
+
+size_t buffer_count() {
+    auto& r = mstd::trace::detail::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.buffers.size();
+}
+
+std::string json() {
+    std::ostringstream os;
+    mstd::trace::write_json(os);
+    return os.str();
+}
+
+size_t count(const std::string& text, const std::string& needle) {
+    size_t n = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+}
+
+// 依次创建的短命线程复用同一个缓冲区, 已经结束的线程的事件仍然可以导出
+TEST(exited_threads_reuse_buffers) {
+    mstd::trace::clear();
+    mstd::trace::instant("test", "main");
+    const size_t before = buffer_count();
+    for (int i = 0; i < 100; ++i) {
+        std::thread([i] {
+            mstd::trace::set_thread_name("worker-" + std::to_string(i));
+            mstd::trace::instant("test", "tick", "i", i);
+        }).join();
+    }
+    CHECK(buffer_count() <= before + 1);
+    const std::string out = json();
+    CHECK_EQ(count(out, "\"name\":\"tick\""), 100u);
+    // 复用的缓冲区只保留最后一个线程的名字
+    CHECK_EQ(count(out, "worker-"), 1u);
+    CHECK_EQ(count(out, "worker-99"), 1u);
+}
+
+// 同时存在的线程各自使用不同的缓冲区
+TEST(live_threads_have_distinct_buffers) {
+    const int n = 4;
+    std::atomic<int> ready{0};
+    std::atomic<bool> release{false};
+    std::vector<std::uint32_t> tids(n);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < n; ++i) {
+        threads.emplace_back([&, i] {
+            tids[static_cast<size_t>(i)] = mstd::trace::detail::local().tid();
+            ++ready;
+            while (!release.load()) std::this_thread::yield();
+        });
+    }
+    while (ready.load() < n) std::this_thread::yield();
+    release = true;
+    for (auto& t : threads) t.join();
+    std::set<std::uint32_t> distinct(tids.begin(), tids.end());
+    distinct.insert(mstd::trace::detail::local().tid());
+    CHECK_EQ(distinct.size(), static_cast<size_t>(n + 1));
+    CHECK_EQ(buffer_count(), static_cast<size_t>(n + 1));
+}
+
+TEST(clear_drops_recorded_events) {
+    mstd::trace::instant("test", "before_clear");
+    mstd::trace::clear();
+    mstd::trace::instant("test", "after_clear");
+    const std::string out = json();
+    CHECK_EQ(count(out, "before_clear"), 0u);
+    CHECK_EQ(count(out, "after_clear"), 1u);
+}
+
+TEST_MAIN()
@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "test.hpp"
+#include "mstd/yaml.hpp"
+
+namespace {
+
+// 把事件记录成一行一个的文本, 方便整体比较
+struct Recorder : mstd::yaml::EventHandler {
+    std::string out;
+    void start_mapping() { out += "{\n"; }
+    void end_mapping() { out += "}\n"; }
+    void start_sequence(bool flow) { out += flow ? "[flow\n" : "[\n"; }
+    void end_sequence() { out += "]\n"; }
+    void on_key(mstd::string_view key) { out += "key " + key.to_std_string() + "\n"; }
+    void on_scalar(mstd::string_view value, bool quoted) {
+        out += (quoted ? "quoted " : "scalar ") + value.to_std_string() + "\n";
+    }
+};
+
+std::string events(const std::string& text) {
+    Recorder recorder;
+    mstd::yaml::parseEvents(mstd::string_view(text.data(), text.size()), recorder);
+    return recorder.out;
+}
+
+std::string stream_events(const std::string& text, size_t chunk_size) {
+    std::istringstream in(text);
+    Recorder recorder;
+    mstd::yaml::parseEvents(in, recorder, chunk_size);
+    return recorder.out;
+}
+
+const char* sample =
+    "# header\n"
+    "server:\n"
+    "  host: \"localhost\"\n"
+    "  ports: [80, 443]\n"
+    "\n"
+    "  replicas:\n"
+    "    - a\n"
+    "    - name: b\n"
+    "      weight: 2\n"
+    "  empty:\n"
+    "debug: true";
+
+}
+
+TEST(event_order) {
+    CHECK_EQ(events(sample),
+             "{\n"
+             "key server\n{\n"
+             "key host\nquoted localhost\n"
+             "key ports\n[flow\nscalar 80\nscalar 443\n]\n"
+             "key replicas\n[\nscalar a\n{\nkey name\nscalar b\nkey weight\nscalar 2\n}\n]\n"
+             "key empty\n{\n}\n"
+             "}\n"
+             "key debug\nscalar true\n"
+             "}\n");
+}
+
+TEST(empty_input) {
+    CHECK_EQ(events(""), "{\n}\n");
+    CHECK_EQ(events("# only a comment\n\n"), "{\n}\n");
+}
+
+// 分块读取的结果与整块解析一致, 块大小小于一行时缓冲区会自动扩大
+TEST(stream_matches_memory) {
+    std::string text = sample;
+    for (int i = 0; i < 200; ++i) {
+        text += "\nkey_" + std::to_string(i) + ":\n  value: " + std::string(static_cast<size_t>(i), 'x');
+    }
+    text += "\n";
+    const std::string expected = events(text);
+    for (size_t chunk : {1u, 7u, 64u, 100u, 4096u, 1u << 20}) {
+        CHECK_EQ(stream_events(text, chunk), expected);
+    }
+    // 最后一行没有换行符
+    CHECK_EQ(stream_events(sample, 16), events(sample));
+}
+
+TEST(parse_events_file) {
+    const char* path = "yaml_events_test.yaml";
+    std::ofstream(path, std::ios::binary) << sample;
+    Recorder recorder;
+    mstd::yaml::parseEventsFile(path, recorder, 32);
+    CHECK_EQ(recorder.out, events(sample));
+    std::remove(path);
+    CHECK_THROWS(mstd::yaml::parseEventsFile(path, recorder));
+}
+
+TEST(invalid_lines_throw) {
+    CHECK_THROWS(events("just text\n"));
+    CHECK_THROWS(events("list:\n  - a\n  b\n"));
+}
+
+TEST_MAIN()
@@ -0,0 +1,115 @@
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include "test.hpp"
+#include "mstd/yaml.hpp"
+
+// 统计堆分配次数
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const char* text =
+    "server:\n"
+    "  features:\n"
+    "    enable_x: true\n"
+    "  items:\n"
+    "    - name: first\n"
+    "    - name: second\n"
+    "      ports: [80, 443]\n"
+    "  matrix:\n"
+    "    - - 1\n"
+    "      - 2\n";
+
+}
+
+TEST(string_paths) {
+    auto reader = mstd::YamlReader::fromString(text);
+    CHECK_EQ(reader.get<bool>("server.features.enable_x"), true);
+    CHECK_EQ(reader.get<std::string>("server.items[1].name"), "second");
+    CHECK_EQ(reader.get<std::string>("server.items[1].ports[1]"), "443");
+    CHECK_EQ(reader.get<int>("server.matrix[0][1]"), 2);
+    CHECK_EQ(reader.at("server.items").size(), 2u);
+    CHECK_EQ(reader.at("server").get<std::string>("items[0].name"), "first");
+    CHECK(reader.has("server.items[0]"));
+    CHECK(!reader.has("server.items[2]"));
+    CHECK(!reader.has("server.features.enable_y"));
+    CHECK(!reader.has("server.items.name"));
+    CHECK_THROWS(reader.get<int>("server.missing"));
+}
+
+// 按字符串路径读取成功时不分配内存, 路径只在抛出异常时才复制
+TEST(string_path_get_does_not_allocate) {
+    auto reader = mstd::YamlReader::fromString(text);
+    const std::size_t before = allocations;
+    bool x = reader.get<bool>("server.features.enable_x");
+    int cell = reader.get<int>("server.matrix[0][1]");
+    CHECK_EQ(allocations - before, 0u);
+    CHECK(x);
+    CHECK_EQ(cell, 2);
+    std::string message;
+    try {
+        reader.get<int>("server.features.enable_x");
+    } catch (const std::runtime_error& e) {
+        message = e.what();
+    }
+    CHECK_EQ(message, "Type mismatch for key: server.features.enable_x");
+}
+
+TEST(malformed_paths_throw) {
+    auto reader = mstd::YamlReader::fromString(text);
+    const char* bad[] = {
+        "server.items[3x]", "server.items[x]", "server.items[]", "server.items[-1]",
+        "server.items[1", "server.items[1]name", "server..items", "server.", ".server",
+        "server.[1]", "server.items[99999999999]",
+    };
+    for (const char* path : bad) {
+        bool threw = false;
+        try {
+            reader.has(path);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        if (!threw) test::fail(__FILE__, __LINE__, std::string("accepted malformed path: ") + path);
+        CHECK_THROWS(mstd::YamlPath{path});
+    }
+}
+
+// 格式错误时即使前面的段已经找不到也要抛出异常
+TEST(malformed_tail_after_missing_key_throws) {
+    auto reader = mstd::YamlReader::fromString(text);
+    CHECK_THROWS(reader.has("nothing.items[3x]"));
+}
+
+TEST(cached_path_follows_document) {
+    const mstd::YamlPath path("server.items[1].name");
+    auto a = mstd::YamlReader::fromString(text);
+    auto b = mstd::YamlReader::fromString("server:\n  items:\n    - name: a\n    - name: b\n");
+    for (int i = 0; i < 3; ++i) {
+        CHECK_EQ(a.get<std::string>(path), "second");
+        CHECK_EQ(b.get<std::string>(path), "b");
+    }
+    const mstd::YamlPath copy = path;
+    CHECK_EQ(copy.str(), "server.items[1].name");
+    CHECK_EQ(a.get<std::string>(copy), "second");
+    // 从子节点开始解析不使用缓存
+    CHECK_EQ(a.at("server").get<std::string>(mstd::YamlPath("items[0].name")), "first");
+    CHECK(!a.has(mstd::YamlPath("server.items[5]")));
+}
+
+TEST_MAIN()
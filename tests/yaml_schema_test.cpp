@@ -0,0 +1,170 @@
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "test.hpp"
+#include "mstd/yaml_schema.hpp"
+
+namespace {
+
+struct Endpoint {
+    std::string name;
+    std::uint16_t port = 0;
+};
+
+struct Service {
+    std::string host;
+    int workers = 4;
+    double ratio = 0;
+    bool enabled = false;
+    std::optional<int> timeout;
+    std::vector<Endpoint> endpoints;
+    std::vector<bool> flags;
+    std::map<std::string, int> limits;
+};
+
+// 与 Endpoint 字段名相同、顺序相反, 检查每个类型的 key id 按自己的字段下标缓存
+struct Route {
+    std::uint16_t port = 0;
+    std::string name;
+    std::vector<Endpoint> backends;
+};
+
+}
+
+template <> struct mstd::yaml::schema<Endpoint> {
+    static constexpr auto fields = std::make_tuple(
+        mstd::yaml::field("name", &Endpoint::name),
+        mstd::yaml::field("port", &Endpoint::port));
+};
+
+template <> struct mstd::yaml::schema<Service> {
+    static constexpr auto fields = std::make_tuple(
+        mstd::yaml::field("host", &Service::host),
+        mstd::yaml::field("workers", &Service::workers).optional(),
+        mstd::yaml::field("ratio", &Service::ratio),
+        mstd::yaml::field("enabled", &Service::enabled),
+        mstd::yaml::field("timeout", &Service::timeout),
+        mstd::yaml::field("endpoints", &Service::endpoints),
+        mstd::yaml::field("flags", &Service::flags).optional(),
+        mstd::yaml::field("limits", &Service::limits).optional());
+};
+
+template <> struct mstd::yaml::schema<Route> {
+    static constexpr auto fields = std::make_tuple(
+        mstd::yaml::field("port", &Route::port),
+        mstd::yaml::field("name", &Route::name),
+        mstd::yaml::field("backends", &Route::backends).optional());
+};
+
+namespace {
+
+mstd::YamlReader parse(const char* text) {
+    return mstd::YamlReader::fromString(text);
+}
+
+// 解码失败时返回异常信息, 没有抛出时返回空字符串
+template <typename T>
+std::string decode_error(const char* text) {
+    try {
+        mstd::yaml::decode<T>(parse(text));
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return std::string();
+}
+
+}
+
+TEST(decode_struct) {
+    auto service = mstd::yaml::decode<Service>(parse(
+        "host: example.com\n"
+        "ratio: 1\n"
+        "enabled: true\n"
+        "timeout: 30\n"
+        "endpoints:\n"
+        "  - name: http\n"
+        "    port: 80\n"
+        "  - name: https\n"
+        "    port: 443\n"
+        "flags:\n"
+        "  - true\n"
+        "  - false\n"
+        "limits:\n"
+        "  connections: 100\n"
+        "  requests: 5\n"
+        "  connections: 7\n"));
+    CHECK_EQ(service.host, "example.com");
+    CHECK_EQ(service.workers, 4);
+    CHECK_EQ(service.ratio, 1.0);
+    CHECK(service.enabled);
+    CHECK(service.timeout && *service.timeout == 30);
+    CHECK_EQ(service.endpoints.size(), 2u);
+    CHECK_EQ(service.endpoints[1].name, "https");
+    CHECK_EQ(service.endpoints[1].port, 443);
+    CHECK(service.flags == (std::vector<bool>{true, false}));
+    CHECK_EQ(service.limits.size(), 2u);
+    CHECK_EQ(service.limits["connections"], 100);
+}
+
+TEST(optional_fields_keep_existing_values) {
+    Service service;
+    service.workers = 9;
+    service.timeout = 5;
+    mstd::yaml::decode(parse("host: h\nratio: 0.5\nenabled: false\nendpoints: []\n"), service);
+    CHECK_EQ(service.workers, 9);
+    CHECK(!service.timeout);
+    CHECK(service.endpoints.empty());
+}
+
+TEST(errors_carry_path) {
+    CHECK_EQ(decode_error<Service>("ratio: 1\nenabled: true\nendpoints: []\n"),
+             "host: missing required field");
+    CHECK_EQ(decode_error<Service>("host: h\nratio: 1\nenabled: yes\nendpoints: []\n"),
+             "enabled: type mismatch (expected bool, got string)");
+    CHECK_EQ(decode_error<Service>("host: h\nratio: 1\nenabled: true\nendpoints:\n  - name: a\n    port: 70000\n"),
+             "endpoints[0].port: value out of range");
+    CHECK_EQ(decode_error<Service>("host: h\nratio: 1\nenabled: true\nendpoints:\n  - name: a\n"),
+             "endpoints[0].port: missing required field");
+    CHECK_EQ(decode_error<std::vector<int>>("a: 1\n"), "<root>: type mismatch (expected array, got object)");
+}
+
+TEST(decode_sub_object) {
+    auto reader = parse("services:\n  api:\n    name: api\n    port: 8080\n");
+    auto endpoint = mstd::yaml::decode<Endpoint>(reader.at("services.api"));
+    CHECK_EQ(endpoint.name, "api");
+    CHECK_EQ(endpoint.port, 8080);
+    auto all = mstd::yaml::decode<std::map<std::string, Endpoint>>(reader.getObject("services"));
+    CHECK_EQ(all.size(), 1u);
+    CHECK_EQ(all["api"].port, 8080);
+}
+
+TEST(types_sharing_field_names) {
+    auto reader = parse(
+        "routes:\n"
+        "  - port: 80\n"
+        "    name: web\n"
+        "    backends:\n"
+        "      - name: a\n"
+        "        port: 8001\n"
+        "      - port: 8002\n"
+        "        name: b\n"
+        "  - name: api\n"
+        "    port: 81\n");
+    auto routes = mstd::yaml::decode<std::vector<Route>>(reader.at("routes"));
+    CHECK_EQ(routes.size(), 2u);
+    CHECK_EQ(routes[0].name, "web");
+    CHECK_EQ(routes[0].port, 80);
+    CHECK_EQ(routes[0].backends.size(), 2u);
+    CHECK_EQ(routes[0].backends[1].name, "b");
+    CHECK_EQ(routes[0].backends[1].port, 8002);
+    CHECK_EQ(routes[1].name, "api");
+    CHECK(routes[1].backends.empty());
+    // 另一个文档的 key id 不同, 每次解码重新建立缓存
+    auto other = parse("list:\n  - extra: 1\n    port: 9\n    name: x\n");
+    auto endpoints = mstd::yaml::decode<std::vector<Endpoint>>(other.at("list"));
+    CHECK(endpoints.size() == 1u && endpoints[0].name == "x" && endpoints[0].port == 9);
+}
+
+TEST_MAIN()
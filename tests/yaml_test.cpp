@@ -0,0 +1,147 @@
+#include <string>
+#include "test.hpp"
+#include "mstd/yaml.hpp"
+
+namespace {
+
+mstd::YamlReader parse(const std::string& text) {
+    return mstd::YamlReader::fromString(mstd::string_view(text.data(), text.size()));
+}
+
+}
+
+TEST(scalar_types) {
+    auto reader = parse(
+        "# comment\n"
+        "name: \"hello world\"\n"
+        "plain: some text\n"
+        "count: -42\n"
+        "ratio: 0.25\n"
+        "exp: 1e3\n"
+        "version: 1.2.3\n"
+        "on: true\n"
+        "off: false\n"
+        "word: nan\n");
+    CHECK_EQ(reader.getValue<std::string>("name"), "hello world");
+    CHECK_EQ(reader.getValue<std::string>("plain"), "some text");
+    CHECK_EQ(reader.getValue<int>("count"), -42);
+    CHECK_EQ(reader.getValue<double>("ratio"), 0.25);
+    CHECK_EQ(reader.getValue<double>("exp"), 1000.0);
+    CHECK_EQ(reader.getValue<std::string>("version"), "1.2.3");
+    CHECK_EQ(reader.getValue<bool>("on"), true);
+    CHECK_EQ(reader.getValue<bool>("off"), false);
+    CHECK_EQ(reader.getValue<std::string>("word"), "nan");
+    CHECK_THROWS(reader.getValue<int>("name"));
+    CHECK_THROWS(reader.getValue<int>("missing"));
+}
+
+TEST(nested_objects_and_arrays) {
+    auto reader = parse(
+        "server:\n"
+        "  host: localhost\n"
+        "  limits:\n"
+        "    connections: 100\n"
+        "  tags: [a, b, c]\n"
+        "  replicas:\n"
+        "    - r1\n"
+        "    - r2\n"
+        "  users:\n"
+        "  - name: alice\n"
+        "    admin: true\n"
+        "  - name: bob\n"
+        "    admin: false\n"
+        "empty:\n"
+        "after: 1\n");
+    auto server = reader.getObject("server");
+    CHECK_EQ(server.getValue<std::string>("host"), "localhost");
+    CHECK_EQ(server.getObject("limits").getValue<int>("connections"), 100);
+    CHECK_EQ(server.size(), 5u);
+
+    auto tags = server.getArray("tags");
+    CHECK_EQ(tags.size(), 3u);
+    CHECK_EQ(tags[2].as<std::string>(), "c");
+
+    auto replicas = server.getArray("replicas");
+    CHECK_EQ(replicas.size(), 2u);
+    CHECK_EQ(replicas[1].getValue<std::string>("value"), "r2");
+
+    auto users = server.getArray("users");
+    CHECK_EQ(users.size(), 2u);
+    CHECK_EQ(users[1].getValue<std::string>("name"), "bob");
+    CHECK_EQ(users[0].getValue<bool>("admin"), true);
+
+    CHECK(reader.getObject("empty").size() == 0);
+    CHECK_EQ(reader.getValue<int>("after"), 1);
+}
+
+TEST(flow_sequence_elements_are_strings) {
+    auto reader = parse("ports: [80, \"443\", 8080]\n");
+    auto ports = reader.getArray("ports");
+    CHECK_EQ(ports.size(), 3u);
+    CHECK_EQ(ports[0].as<std::string>(), "80");
+    CHECK_EQ(ports[1].as<std::string>(), "443");
+}
+
+// 重复的 key 以第一次出现为准, 小对象走顺序查找, 大对象走哈希索引, 两者结果一致
+TEST(duplicate_keys_first_wins) {
+    auto small = parse("a: 1\nb: 2\na: 3\n");
+    CHECK_EQ(small.getValue<int>("a"), 1);
+
+    std::string text = "dup: first\n";
+    for (int i = 0; i < 40; ++i) text += "k" + std::to_string(i) + ": " + std::to_string(i) + "\n";
+    text += "dup: last\n";
+    auto large = parse(text);
+    CHECK_EQ(large.getValue<std::string>("dup"), "first");
+    CHECK_EQ(large.getValue<int>("k39"), 39);
+}
+
+TEST(large_object_lookup) {
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += "s" + std::to_string(i) + ":\n  id: " + std::to_string(i) + "\n";
+    }
+    auto reader = parse(text);
+    CHECK_EQ(reader.size(), 1000u);
+    for (int i = 0; i < 1000; i += 37) {
+        CHECK_EQ(reader.get<int>("s" + std::to_string(i) + ".id"), i);
+    }
+    CHECK(!reader.hasKey("s1000"));
+    CHECK(!reader.hasKey("id"));
+}
+
+TEST(crlf_and_trailing_whitespace) {
+    auto reader = parse("a: 1  \r\nb:\r\n  c: x\t\r\n");
+    CHECK_EQ(reader.getValue<int>("a"), 1);
+    CHECK_EQ(reader.get<std::string>("b.c"), "x");
+}
+
+// "- - x" 是嵌套数组, 不是字符串 "- x"
+TEST(nested_inline_sequences) {
+    auto reader = parse(
+        "matrix:\n"
+        "  - - 1\n"
+        "    - 2\n"
+        "  - - - deep\n"
+        "  - -\n"
+        "      - late\n"
+        "  - - name: x\n"
+        "      id: 7\n"
+        "  - tail\n");
+    auto rows = reader.getArray("matrix");
+    CHECK_EQ(rows.size(), 5u);
+    CHECK(rows[0].type() == mstd::yaml::NodeType::Array);
+    CHECK_EQ(rows[0].size(), 2u);
+    CHECK_EQ(rows[0].get<int>("[0]"), 1);
+    CHECK_EQ(rows[0].get<int>("[1]"), 2);
+    CHECK_EQ(rows[1].get<std::string>("[0][0]"), "deep");
+    CHECK(rows[2].type() == mstd::yaml::NodeType::Array);
+    CHECK_EQ(rows[2].get<std::string>("[0][0]"), "late");
+    CHECK_EQ(rows[3].get<int>("[0].id"), 7);
+    CHECK_EQ(rows[4].as<std::string>(), "tail");
+}
+
+TEST(array_item_without_parent_throws) {
+    CHECK_THROWS(parse("- a\n"));
+}
+
+TEST_MAIN()